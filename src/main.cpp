@@ -4,31 +4,40 @@
 #include "mq_log.h"
 #include "mq_configuration.h"
 #include "mq_connection.h"
+#include "mq_connection_pool.h"
 #include "mq_queue_status.h"
 #include "mq_args.h"
 #include "mq_pcf_status_inquirer.h"
+#include "mq_row_sink.h"
+#include "mq_status_snapshot.h"
+#include "mq_snapshot_file.h"
+#include "mq_async_engine.h"
+#include "mq_poll_scheduler.h"
+#include "mq_job_scheduler.h"
+#include "mq_circuit_breaker.h"
 #include "mq_thread_pool.h"
 #include "mq_operations.h"
 #include <map>
+#include <unordered_set>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
-#include <mutex>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <csignal>
 
 using namespace std;
 
-// Mutex for CSV file writing from multiple threads
-static mutex csvMutex;
-
 // Generate a timestamp suffix for filenames: _YYYYMMDD_HHMMSS
-static string generateFileTimestamp() {
-    time_t now = time(0);
+static string generateFileTimestamp(time_t when = time(0)) {
     struct tm timeinfo;
 #ifdef _WIN32
-    localtime_s(&timeinfo, &now);
+    localtime_s(&timeinfo, &when);
 #else
-    localtime_r(&now, &timeinfo);
+    localtime_r(&when, &timeinfo);
 #endif
     ostringstream oss;
     oss << "_" << put_time(&timeinfo, "%Y%m%d_%H%M%S");
@@ -46,8 +55,332 @@ static string appendTimestampToPath(const string& path, const string& timestamp)
     return path + timestamp;
 }
 
-void generateCSVReport(const vector<PCFQueueData>& queues, const string& csvPath,
-                       const string& qmName, MQLog& logger);
+// Resolve the server-side status filter for a queue manager: CLI, then [queuemanager.X], then [global]
+static bool resolveStatusFilter(const QMConfig& qmCfg, const GlobalConfig& globalConfig,
+                                const string& cliQueueFilter, const string& cliStatusFilter,
+                                PCFStatusFilter& filter, string& error) {
+    const string& names = !cliQueueFilter.empty() ? cliQueueFilter :
+                          !qmCfg.queueFilter.empty() ? qmCfg.queueFilter : globalConfig.queueFilter;
+    const string& condition = !cliStatusFilter.empty() ? cliStatusFilter :
+                              !qmCfg.statusFilter.empty() ? qmCfg.statusFilter : globalConfig.statusFilter;
+
+    if (!PCFStatusFilter::parseQueueNames(names, filter.queueNames, error)) return false;
+    if (!condition.empty() && !PCFStatusFilter::parseCondition(condition, filter, error)) return false;
+    return true;
+}
+
+// Report files of a poll; an empty path turns that output off
+struct OutputPaths {
+    string csv;
+    string snapshot;
+};
+
+/**
+ * Send one poll's rows to the log table, the CSV report (through csvWriter)
+ * and a snapshot, which is appended to the snapshot file (through
+ * snapshotWriter), then log the summary. poll(emitRow) runs or finishes the
+ * poll, calling emitRow for each row, and returns the row count.
+ */
+template <typename PollFunction>
+static void reportQueueStatus(MQLog& logger, CSVFileWriter& csvWriter, SnapshotFileWriter& snapshotWriter,
+                              const OutputPaths& paths, const string& qmName,
+                              MQPCFStatusInquirer& inquirer, atomic<int>& partialResults,
+                              PollFunction&& poll) {
+    // Rows go straight from the parsed replies to the log table and CSV
+    LogTableSink tableSink(logger, qmName);
+    unique_ptr<CSVRowSink> csvSink;
+    if (!paths.csv.empty()) {
+        csvSink.reset(new CSVRowSink(logger, csvWriter, paths.csv, qmName));
+    }
+    StatusSnapshot snapshot(qmName);
+    auto emitRow = [&](const PCFStatusRow& row) {
+        tableSink.row(row);
+        if (csvSink) csvSink->row(row);
+        snapshot.append(row);
+    };
+
+    size_t rowCount = poll(emitRow);
+    tableSink.finish(rowCount);
+    if (csvSink) csvSink->finish(rowCount);
+
+    if (inquirer.lastPollPartial()) {
+        snapshot.markPartial();
+        partialResults++;
+        logger.warning("Result for {} is PARTIAL: {} rows from an incomplete poll ({} inquir(ies) unanswered within {} ms)",
+                       qmName, rowCount, inquirer.lastPollIncomplete(), inquirer.replyBudgetMs());
+    }
+
+    // The summary walks every column, so it is only built when it will be logged
+    if (rowCount > 0 && logger.enabled()) {
+        SnapshotSummary summary = snapshot.summarize();
+        string deepest;
+        if (summary.maxDepth > 0) {
+            deepest = ", deepest " + string(summary.deepestQueue) + " at " + to_string(summary.maxDepth);
+        }
+        logger.info("Snapshot {}: {} queues ({} with messages, total depth {}{}), {} handles "
+                    "({} readers, {} writers), {} KiB columnar",
+                    qmName, summary.queues, summary.queuesWithMessages, summary.totalDepth, deepest,
+                    summary.handles, summary.readers, summary.writers, snapshot.memoryBytes() / 1024);
+    }
+
+    if (!paths.snapshot.empty() && snapshotWriter.append(paths.snapshot, snapshot) && rowCount > 0) {
+        logger.info("Snapshot appended to: {}", paths.snapshot);
+    }
+}
+
+// What a status poll needs besides its queue manager; shared by one-shot and daemon runs
+struct StatusPollContext {
+    MQLog& logger;
+    CSVFileWriter& csvWriter;
+    SnapshotFileWriter& snapshotWriter;
+    const GlobalConfig& globalConfig;
+    string cliQueueFilter;
+    string cliStatusFilter;
+    bool streaming;
+    atomic<int>& partialResults;
+    MQAsyncPCFEngine* asyncEngine;
+    MQConnectionPool& connectionPool;
+    MQCircuitBreaker& breaker;
+};
+
+/**
+ * Lease a connection to qmCfg unless its circuit is open, and tell the
+ * breaker how the attempt went. Returns an empty lease if the queue manager
+ * was skipped or could not be reached.
+ */
+static MQConnectionLease connectGuarded(MQLog& logger, MQConnectionPool& connectionPool,
+                                        MQCircuitBreaker& breaker, const QMConfig& qmCfg) {
+    if (!breaker.allow(qmCfg.queueManager)) return MQConnectionLease();
+
+    MQLONG reason = MQRC_NONE;
+    MQConnectionLease lease = connectionPool.acquire(qmCfg, &reason);
+    if (!lease) {
+        logger.errorFor(qmCfg.queueManager, reason, "Failed to connect to {}", qmCfg.queueManager);
+        breaker.recordFailure(qmCfg.queueManager, reason);
+        return lease;
+    }
+    breaker.recordSuccess(qmCfg.queueManager);
+    return lease;
+}
+
+/**
+ * After a poll that sent no inquiry because its connection broke (typically
+ * a pooled connection that died while idle), swap the lease for a new
+ * connection and point the inquirer at its session. Nothing has been
+ * reported for such a poll, so it can simply run again. False if the poll
+ * failed some other way or no new connection could be made.
+ */
+static bool reconnectUnsentPoll(const StatusPollContext& ctx, const QMConfig& qmCfg, MQConnectionLease& lease,
+                                MQPCFStatusInquirer& inquirer) {
+    MQLONG failure = lease.session().failureReason();
+    if (!inquirer.lastPollUnsent() || !MQConnectionPool::isConnectionFatal(failure)) return false;
+    ctx.logger.warningFor(qmCfg.queueManager, failure,
+                          "Connection to {} broke before the poll was sent (Reason: {}), retrying on a new connection",
+                          qmCfg.queueManager, failure);
+    lease.release();
+    lease = connectGuarded(ctx.logger, ctx.connectionPool, ctx.breaker, qmCfg);
+    if (!lease) return false;
+    inquirer.useSession(lease.session());
+    return true;
+}
+
+/**
+ * Poll one queue manager's status over a leased connection and report its
+ * rows (to the files in paths as well). With an async engine the
+ * lease moves to the engine and onDone runs once the rows are reported;
+ * otherwise the poll runs here and onDone runs before returning. A report
+ * that throws is logged and still runs onDone. A poll whose connection
+ * broke before it sent anything is retried once on a new connection.
+ */
+static void runStatusPoll(const StatusPollContext& ctx, const QMConfig& qmCfg, MQConnectionLease& lease,
+                          const OutputPaths& paths, function<void()> onDone, bool retryUnsent = true) {
+    MQLog& logger = ctx.logger;
+    PCFStatusFilter filter;
+    string filterError;
+    if (!resolveStatusFilter(qmCfg, ctx.globalConfig, ctx.cliQueueFilter, ctx.cliStatusFilter,
+                             filter, filterError)) {
+        logger.error("Invalid status filter for {}: {}", qmCfg.queueManager, filterError);
+        onDone();
+        return;
+    }
+
+    unique_ptr<MQPCFStatusInquirer> inquirer(
+        new MQPCFStatusInquirer(logger, lease.session(), qmCfg.queueManager));
+    inquirer->setFilter(filter);
+    inquirer->setReplyBudget(qmCfg.inquiryTimeoutMs > 0 ? qmCfg.inquiryTimeoutMs
+                                                        : ctx.globalConfig.inquiryTimeoutMs);
+
+    if (ctx.asyncEngine && MQAsyncPCFEngine::supports(lease.session())) {
+        // The poll holds the lease from here on and reports when its replies are in
+        unique_ptr<AsyncStatusPoll> poll(new AsyncStatusPoll());
+        poll->qmName = qmCfg.queueManager;
+        poll->lease = move(lease);
+        poll->inquirer = move(inquirer);
+        poll->onComplete = [&ctx, qmCfg, paths, onDone, retryUnsent](AsyncStatusPoll& p) {
+            MQLog& logger = ctx.logger;
+            try {
+                if (retryUnsent && reconnectUnsentPoll(ctx, qmCfg, p.lease, *p.inquirer)) {
+                    runStatusPoll(ctx, qmCfg, p.lease, paths, onDone, false);
+                    return;
+                }
+                reportQueueStatus(logger, ctx.csvWriter, ctx.snapshotWriter, paths, p.qmName, *p.inquirer,
+                                  ctx.partialResults,
+                                  [&p](auto& emitRow) { return p.inquirer->finishAsyncPoll(emitRow); });
+            } catch (const exception& e) {
+                logger.error("Reporting {} failed: {}", p.qmName, e.what());
+            }
+            p.lease.release();
+            onDone();
+        };
+        ctx.asyncEngine->submit(move(poll));
+        return;
+    }
+
+    if (ctx.asyncEngine) {
+        logger.info("Shared reply queue {} on {} is polled synchronously",
+                    qmCfg.replyQueue, qmCfg.queueManager);
+    }
+    bool streaming = ctx.streaming;
+    try {
+        reportQueueStatus(logger, ctx.csvWriter, ctx.snapshotWriter, paths, qmCfg.queueManager, *inquirer,
+                          ctx.partialResults,
+                          [&](auto& emitRow) {
+                              size_t rows = streaming ? inquirer->streamQueueStatuses(emitRow)
+                                                      : inquirer->inquireQueueStatuses(emitRow);
+                              if (retryUnsent && reconnectUnsentPoll(ctx, qmCfg, lease, *inquirer)) {
+                                  rows = streaming ? inquirer->streamQueueStatuses(emitRow)
+                                                   : inquirer->inquireQueueStatuses(emitRow);
+                              }
+                              return rows;
+                          });
+    } catch (const exception& e) {
+        logger.error("Reporting {} failed: {}", qmCfg.queueManager, e.what());
+    }
+    onDone();
+}
+
+// Set by SIGINT/SIGTERM; the daemon finishes the polls in progress and exits
+static atomic<bool> stopRequested(false);
+
+static void requestStop(int) {
+    stopRequested = true;
+}
+
+/**
+ * Daemon mode: poll every queue manager on its own interval until SIGINT or
+ * SIGTERM. Connections and PCF sessions stay in the pool between polls, and
+ * the log, CSV and snapshot files roll over at every multiple of
+ * roll_interval_min.
+ */
+static void runDaemon(const StatusPollContext& ctx, const vector<QMConfig>& qms, ThreadPool& pool,
+                      const string& logBasePath, const OutputPaths& basePaths, OutputPaths paths) {
+    MQLog& logger = ctx.logger;
+    const GlobalConfig& globalConfig = ctx.globalConfig;
+
+    MQPollScheduler scheduler(logger, globalConfig.pollJitterPct / 100.0);
+    for (const auto& qmCfg : qms) {
+        int interval = qmCfg.pollIntervalSec > 0 ? qmCfg.pollIntervalSec : globalConfig.pollIntervalSec;
+        scheduler.add(qmCfg.queueManager, chrono::seconds(interval));
+        logger.info("Polling {} every {} s", qmCfg.queueManager, interval);
+    }
+
+    // Files roll over on wall-clock multiples of the roll interval
+    time_t rollSeconds = (time_t)max(1, globalConfig.rollIntervalMin) * 60;
+    time_t currentPeriod = time(0) / rollSeconds;
+    auto rollFiles = [&]() {
+        time_t period = time(0) / rollSeconds;
+        if (period == currentPeriod) return;
+        currentPeriod = period;
+        string timestamp = generateFileTimestamp(period * rollSeconds);
+        string logPath = appendTimestampToPath(logBasePath, timestamp);
+        logger.info("Rolling log over to {}", logPath);
+        logger.reopen(logPath);
+        if (!paths.csv.empty()) paths.csv = appendTimestampToPath(basePaths.csv, timestamp);
+        if (!paths.snapshot.empty()) paths.snapshot = appendTimestampToPath(basePaths.snapshot, timestamp);
+    };
+
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    logger.info("Daemon started for {} queue manager(s); stop with SIGINT or SIGTERM", qms.size());
+
+    scheduler.run(stopRequested, [&](size_t id) {
+        OutputPaths pollPaths = paths;
+        pool.post([&ctx, &qms, &scheduler, id, pollPaths]() {
+            const QMConfig& qmCfg = qms[id];
+            // The pool drops a task's exception, and a poll never completed is never scheduled again
+            auto completed = make_shared<atomic<bool>>(false);
+            auto complete = [&scheduler, id, completed]() {
+                if (!completed->exchange(true)) scheduler.complete(id);
+            };
+            try {
+                MQConnectionLease lease = connectGuarded(ctx.logger, ctx.connectionPool, ctx.breaker, qmCfg);
+                if (!lease) {
+                    complete();
+                    return;
+                }
+                runStatusPoll(ctx, qmCfg, lease, pollPaths, complete);
+            } catch (const exception& e) {
+                ctx.logger.error("Poll of {} failed: {}", qmCfg.queueManager, e.what());
+                complete();
+            }
+        });
+    }, rollFiles);
+
+    logger.info("Stop requested, polls in progress have finished");
+    scheduler.logStats();
+}
+
+/**
+ * --dump: print a snapshot file as CSV on stdout, every block or only those
+ * of one queue manager, in queue manager and time order.
+ */
+static int dumpSnapshotFile(const string& path, const string& qmName) {
+    SnapshotFileReader reader;
+    if (!reader.open(path)) {
+        cerr << "ERROR: " << reader.error() << endl;
+        return 1;
+    }
+    if (!reader.hasIndex()) {
+        cerr << "WARNING: " << path << " was not closed by its writer; blocks found by scanning" << endl;
+    }
+
+    const SnapshotIndexEntry* first = reader.index().data();
+    const SnapshotIndexEntry* last = first + reader.index().size();
+    if (!qmName.empty()) tie(first, last) = reader.find(qmName);
+
+    string out = RowFormatter::csvHeader();
+    for (const SnapshotIndexEntry* entry = first; entry != last; ++entry) {
+        SnapshotBlockView block = reader.block(*entry);
+        if (!block.valid()) {
+            cerr << "WARNING: skipped a damaged block of " << entry->queueManager << endl;
+            continue;
+        }
+        string timestamp = CSVRowSink::formatTime(block.takenAt());
+        string_view blockQm = block.queueManager();
+        bool complete = block.forEachRow([&](const PCFStatusRow& row) {
+            RowFormatter::appendCSVRow(out, timestamp, blockQm, row);
+        });
+        if (!complete) {
+            cerr << "WARNING: block of " << blockQm << " has missing or damaged columns; its rows were cut short" << endl;
+        }
+        cout.write(out.data(), (streamsize)out.size());
+        out.clear();
+    }
+    return cout.good() ? 0 : 1;
+}
+
+/**
+ * --decode-log: print a binary log file as the text log it stands for.
+ */
+static int decodeLogFile(const string& path) {
+    BinaryLogDecoder decoder;
+    if (!decoder.decode(path, cout)) {
+        cout.flush();
+        cerr << "ERROR: " << decoder.error() << endl;
+        return 1;
+    }
+    return 0;
+}
 
 int main(int argc, char* argv[]) {
     CommandLineArgs args = CommandLineArgs::parse(argc, argv);
@@ -57,6 +390,14 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    if (!args.dumpFile.empty()) {
+        return dumpSnapshotFile(args.dumpFile, args.queueManager);
+    }
+
+    if (!args.decodeLogFile.empty()) {
+        return decodeLogFile(args.decodeLogFile);
+    }
+
     if (args.configFile.empty()) {
         cerr << "ERROR: --config file is required" << endl;
         return 1;
@@ -79,15 +420,36 @@ int main(int argc, char* argv[]) {
     // Generate timestamp suffix for log and CSV filenames
     string fileTimestamp = generateFileTimestamp();
 
-    string logPath = globalConfig.logPath.empty() ? "MQQStatusTool.log" : globalConfig.logPath;
-    logPath = appendTimestampToPath(logPath, fileTimestamp);
+    string logBasePath = globalConfig.logPath.empty() ? "MQQStatusTool.log" : globalConfig.logPath;
+    string logPath = appendTimestampToPath(logBasePath, fileTimestamp);
 
-    if (globalConfig.generateCSV) {
-        globalConfig.csvPath = appendTimestampToPath(globalConfig.csvPath, fileTimestamp);
-    }
+    OutputPaths basePaths{globalConfig.generateCSV ? globalConfig.csvPath : string(),
+                          globalConfig.generateSnapshot ? globalConfig.snapshotPath : string()};
+    OutputPaths paths;
+    if (!basePaths.csv.empty()) paths.csv = appendTimestampToPath(basePaths.csv, fileTimestamp);
+    if (!basePaths.snapshot.empty()) paths.snapshot = appendTimestampToPath(basePaths.snapshot, fileTimestamp);
 
     // Create logger
-    MQLog logger(logPath, globalConfig.logSizeMB, globalConfig.logBackups);
+    LogOverflow logOverflow = LogOverflow::Block;
+    if (!MQLog::parseOverflow(globalConfig.logOverflow, logOverflow)) {
+        cerr << "ERROR: log_overflow must be block, drop or count, not: " << globalConfig.logOverflow << endl;
+        return 1;
+    }
+    LogFileFormat logFormat = LogFileFormat::Text;
+    if (!MQLog::parseFileFormat(globalConfig.logFormat, logFormat)) {
+        cerr << "ERROR: log_format must be text or binary, not: " << globalConfig.logFormat << endl;
+        return 1;
+    }
+    LogLevel logLevel = LogLevel::Info;
+    if (!MQLog::parseLevel(globalConfig.logLevel, logLevel)) {
+        cerr << "ERROR: log_level must be trace, debug, info, warning or error, not: "
+             << globalConfig.logLevel << endl;
+        return 1;
+    }
+    MQLog logger(logPath, globalConfig.logSizeMB, globalConfig.logBackups,
+                 (size_t)max(16, globalConfig.logQueueSize), logOverflow, logFormat);
+    logger.setLevel(logLevel);
+    logger.setRepeatLimit(globalConfig.logRepeatLimit, globalConfig.logRepeatIntervalSec);
     logger.log("========================================");
     logger.log("IBM MQ Queue Status Tool");
     logger.log("========================================");
@@ -118,202 +480,192 @@ int main(int argc, char* argv[]) {
         qmNamesToProcess.push_back(args.queueManager);
     }
 
-    // Group queue managers by host to avoid duplicate connections
-    map<string, vector<QMConfig>> hostGroups;
+    // Every queue manager is a job of its own; hosts only cap how many run at once.
+    // Names may be patterns ("PROD_*"); a queue manager selected twice is polled once
+    vector<QMConfig> qms;
+    map<string, size_t> qmsPerHost;
+    unordered_set<const QMConfig*> selected;
     for (const auto& qmName : qmNamesToProcess) {
-        QMConfig qmCfg = config.getQueueManager(qmName);
-        if (qmCfg.queueManager.empty()) {
-            logger.error("Queue manager '" + qmName + "' not found in config");
+        vector<const QMConfig*> matches = config.findQueueManagers(qmName);
+        if (matches.empty()) {
+            if (MQConfiguration::isPattern(qmName)) {
+                logger.error("No queue manager in config matches '{}'", qmName);
+            } else {
+                logger.error("Queue manager '{}' not found in config", qmName);
+            }
             continue;
         }
-        hostGroups[qmCfg.host].push_back(qmCfg);
+        for (const QMConfig* qmCfg : matches) {
+            if (qmCfg->queueManager.empty()) {
+                logger.error("Queue manager '{}' has no queue_manager in config", qmCfg->sectionName);
+                continue;
+            }
+            if (!selected.insert(qmCfg).second) continue;
+            qms.push_back(*qmCfg);
+            qmsPerHost[qmCfg->host]++;
+        }
     }
 
-    if (hostGroups.empty()) {
+    if (qms.empty()) {
         logger.error("No valid queue managers to process");
         return 1;
     }
 
-    // Create thread pool (one thread per host, max globalConfig.maxThreads)
-    int poolSize = min(globalConfig.maxThreads, (int)hostGroups.size());
+    // Create thread pool: no more workers than the per-host limit lets run at once
+    // (max globalConfig.maxThreads); a daemon schedules its own polls and uses all of them
+    bool daemon = args.daemon;
+    size_t perHostLimit = (size_t)max(1, globalConfig.maxPerHost);
+    size_t runnable = 0;
+    for (const auto& entry : qmsPerHost) runnable += min(entry.second, perHostLimit);
+    int poolSize = daemon ? globalConfig.maxThreads : min(globalConfig.maxThreads, (int)runnable);
     if (poolSize < 1) poolSize = 1;
-    logger.info("Starting thread pool with " + to_string(poolSize) + " worker(s) for " +
-                to_string(hostGroups.size()) + " host(s)");
-
+    logger.info("Starting thread pool with {} worker(s) for {} queue manager(s) on {} host(s)",
+                poolSize, qms.size(), qmsPerHost.size());
+
+    // Connections (with their PCF sessions) are leased per queue manager and kept for reuse;
+    // a daemon keeps them for at least two of its longest polling intervals
+    int longestIntervalSec = globalConfig.pollIntervalSec;
+    for (const auto& qmCfg : qms) longestIntervalSec = max(longestIntervalSec, qmCfg.pollIntervalSec);
+    MQConnectionPool connectionPool(logger, 2, chrono::seconds(max(600, 2 * longestIntervalSec)));
+
+    // Queue managers that keep failing to connect are skipped until their backoff expires
+    MQCircuitBreaker breaker(logger, globalConfig.breakerFailures, globalConfig.breakerBackoffSec,
+                             globalConfig.breakerMaxBackoffSec);
+    breaker.load(globalConfig.healthStatePath);
     ThreadPool pool(poolSize);
 
     // Capture operation flags
-    bool doStatus = args.getAllQueues;
-    bool doGet = args.doGet;
-    bool doPut = args.doPut;
+    bool doStatus = args.getAllQueues || daemon;
+    bool doGet = args.doGet && !daemon;
+    bool doPut = args.doPut && !daemon;
     string targetQueue = args.queueName;
+    atomic<int> partialResults(0);
+
+    // With async replies, workers only connect and put inquiries; replies are
+    // consumed by MQCB callbacks and the rows reported by pool workers once a poll is answered
+    bool streaming = args.streaming || globalConfig.streaming;
+    bool asyncReplies = doStatus && (args.asyncReplies || globalConfig.asyncReplies);
+    unique_ptr<MQAsyncPCFEngine> engine;
+    if (asyncReplies) {
+        if (streaming) logger.info("Streaming is not used with async replies; rows are joined per queue manager");
+        engine.reset(new MQAsyncPCFEngine(logger, &pool));
+    }
 
-    for (auto& entry : hostGroups) {
-        const string host = entry.first;
-        vector<QMConfig> qms = entry.second;
-
-        pool.enqueue([host, qms, &logger, &globalConfig, doStatus, doGet, doPut, targetQueue]() {
-            logger.info("=== Thread processing host: " + host + " with " +
-                        to_string(qms.size()) + " queue manager(s) ===");
-
-            for (const auto& qmCfg : qms) {
-                logger.info("Processing: " + qmCfg.queueManager + " on " + host);
-
-                MQConnection mqConn(logger);
-                mqConn.setConnectionDetails(qmCfg.queueManager, qmCfg.host,
-                                           qmCfg.port, qmCfg.channel, qmCfg.queueName);
-
-                if (!mqConn.connect()) {
-                    logger.error("Failed to connect to " + qmCfg.queueManager);
-                    continue;
+    // Every CSV report is written by one thread; workers only hand over filled buffers
+    CSVFileWriter csvWriter(logger, CSVRowSink::header());
+    SnapshotFileWriter snapshotWriter(logger);
+
+    StatusPollContext statusContext{logger, csvWriter, snapshotWriter, globalConfig, args.queueFilter,
+                                    args.statusFilter, streaming, partialResults, engine.get(),
+                                    connectionPool, breaker};
+
+    if (daemon) {
+        runDaemon(statusContext, qms, pool, logBasePath, basePaths, paths);
+    } else {
+        // Last run's durations put the longest queue managers first
+        PollDurationHistory durations;
+        durations.load(globalConfig.durationHistoryPath);
+        MQJobScheduler scheduler(logger, durations, perHostLimit);
+
+        for (const auto& qmCfg : qms) {
+            scheduler.add(qmCfg.queueManager, qmCfg.host,
+                          [qmCfg, &logger, doStatus, doGet, doPut, targetQueue, paths,
+                           &statusContext, &connectionPool, &breaker](MQJobScheduler::Done done) {
+                logger.info("Processing: {} on {}", qmCfg.queueManager, qmCfg.host);
+
+                MQConnectionLease lease = connectGuarded(logger, connectionPool, breaker, qmCfg);
+                if (!lease) {
+                    done(false);    // Keeps the last real poll's duration for ordering
+                    return;
                 }
 
                 // PUT operation
                 if (doPut) {
                     string queue = targetQueue.empty() ? qmCfg.queueName : targetQueue;
-                    logger.info("Putting test message to queue: " + queue);
+                    logger.info("Putting test message to queue: {}", queue);
 
                     string testMsg = "Test message from MQQStatusTool at " +
                                      to_string(time(nullptr));
-                    MQLONG reason = MQOps::putMessage(mqConn.getHandle(),
+                    MQLONG reason = MQOps::putMessage(lease.handle(),
                                                       queue.c_str(),
                                                       testMsg.c_str(),
                                                       (MQLONG)testMsg.length());
                     if (reason == MQRC_NONE) {
-                        logger.info("Message put successfully to " + queue);
+                        logger.info("Message put successfully to {}", queue);
                     } else {
-                        logger.error("Failed to put message, reason: " + to_string(reason));
+                        logger.error("Failed to put message, reason: {}", reason);
                     }
                 }
 
                 // GET operation
                 if (doGet) {
                     string queue = targetQueue.empty() ? qmCfg.queueName : targetQueue;
-                    logger.info("Getting message from queue: " + queue);
+                    logger.info("Getting message from queue: {}", queue);
 
                     unsigned char buffer[4096];
                     memset(buffer, 0, sizeof(buffer));
                     MQLONG dataLen = 0;
-                    MQLONG reason = MQOps::getMessage(mqConn.getHandle(),
+                    MQLONG reason = MQOps::getMessage(lease.handle(),
                                                       queue.c_str(),
                                                       buffer, sizeof(buffer),
                                                       dataLen, 5000);
                     if (reason == MQRC_NONE) {
-                        logger.info("Message received (" + to_string(dataLen) + " bytes): " +
-                                    string((char*)buffer, dataLen));
+                        logger.info("Message received ({} bytes): {}", dataLen,
+                                    string_view((char*)buffer, dataLen));
                     } else if (reason == MQRC_NO_MSG_AVAILABLE) {
-                        logger.info("No messages available on " + queue);
+                        logger.info("No messages available on {}", queue);
                     } else {
-                        logger.error("Failed to get message, reason: " + to_string(reason));
+                        logger.error("Failed to get message, reason: {}", reason);
                     }
                 }
 
                 // STATUS operation (default) - Use PCF to get all local queues
+                string qmName = qmCfg.queueManager;
+                auto completed = [&logger, qmName, done]() {
+                    logger.info("Completed: {}", qmName);
+                    done(true);
+                };
                 if (doStatus) {
-                    MQPCFStatusInquirer inquirer(logger, mqConn.getHandle());
-                    vector<PCFQueueData> queueStatuses = inquirer.inquireAllQueueStatuses();
-
-                    if (queueStatuses.empty()) {
-                        logger.warning("No queues returned from PCF for " + qmCfg.queueManager);
-                    } else {
-                        logger.log("");
-                        logger.log("========================================");
-                        logger.log("QUEUE STATUS REPORT - " + qmCfg.queueManager);
-                        logger.log("========================================");
-                        logger.log("");
-                        logger.log("Queue Name                         | Type    | Depth | Input | Output | Connection       | Channel          | User         | PID   | AppTag                    | Process_Type | Role");
-                        logger.log("--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------");
-
-                        for (const auto& q : queueStatuses) {
-                            ostringstream oss;
-                            oss << left << setw(35) << q.queueName << "| "
-                                << setw(8) << q.queueType << "| "
-                                << right << setw(5) << q.currentDepth << " | "
-                                << setw(5) << q.openInputCount << " | "
-                                << setw(6) << q.openOutputCount << " | "
-                                << left << setw(17) << q.connection << "| "
-                                << setw(17) << q.channelName << "| "
-                                << setw(13) << q.user << "| "
-                                << right << setw(5) << q.processId << " | "
-                                << left << setw(26) << q.applicationTag << "| "
-                                << setw(13) << q.processType << "| "
-                                << q.role;
-                            logger.log(oss.str());
-                        }
-
-                        logger.log("--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------");
-                        logger.log("Total: " + to_string(queueStatuses.size()) + " rows");
-                        logger.log("");
-
-                        // Generate CSV if enabled
-                        if (globalConfig.generateCSV) {
-                            generateCSVReport(queueStatuses, globalConfig.csvPath,
-                                            qmCfg.queueManager, logger);
-                        }
-                    }
+                    runStatusPoll(statusContext, qmCfg, lease, paths, completed);
+                } else {
+                    completed();
                 }
+            });
+        }
 
-                mqConn.disconnect();
-                logger.info("Completed: " + qmCfg.queueManager);
-            }
-        });
+        scheduler.run(pool, (size_t)poolSize);
+        if (!durations.save(globalConfig.durationHistoryPath)) {
+            logger.warning("Could not save poll durations to {}", globalConfig.durationHistoryPath);
+        }
     }
 
     // Wait for all threads to complete
     pool.waitAll();
     logger.info("Thread pool shutdown complete");
-
-    logger.log("========================================");
-    logger.info("Operation completed successfully");
-    return 0;
-}
-
-void generateCSVReport(const vector<PCFQueueData>& queues, const string& csvPath,
-                       const string& qmName, MQLog& logger) {
-    try {
-        lock_guard<mutex> guard(csvMutex);
-
-        // Get current timestamp
-        time_t now = time(0);
-        struct tm timeinfo;
-#ifdef _WIN32
-        localtime_s(&timeinfo, &now);
-#else
-        localtime_r(&now, &timeinfo);
-#endif
-        ostringstream timestampOss;
-        timestampOss << put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
-        string timestamp = timestampOss.str();
-
-        // Check if file exists to determine if header is needed
-        bool writeHeader = true;
-        {
-            ifstream check(csvPath);
-            if (check.good() && check.peek() != ifstream::traits_type::eof()) {
-                writeHeader = false;
-            }
-        }
-
-        ofstream csvFile(csvPath, ios::app);
-        if (!csvFile.is_open()) {
-            logger.error("Could not open CSV file: " + csvPath);
-            return;
-        }
-
-        if (writeHeader) {
-            csvFile << "Timestamp,Queue_Manager,Queue_Name,Queue_Type,Current_Depth,Input_Count,Output_Count,"
-                    << "Connection,Channel,User,Process_ID,Application_Tag,Process_Type,Role\n";
+    if (engine) engine->drain();
+    csvWriter.close();
+    snapshotWriter.close();
+    connectionPool.logStats();
+    connectionPool.closeAll();
+
+    map<string, size_t> skipped = breaker.skipped();
+    if (!skipped.empty()) {
+        string names;
+        for (const auto& entry : skipped) {
+            if (!names.empty()) names += ", ";
+            names += entry.first + (entry.second > 1 ? " (" + to_string(entry.second) + "x)" : string());
         }
+        logger.warning("Skipped {} queue manager(s) with an open circuit: {}", skipped.size(), names);
+    }
+    if (!breaker.save(globalConfig.healthStatePath)) {
+        logger.warning("Could not save queue manager health to {}", globalConfig.healthStatePath);
+    }
 
-        for (const auto& q : queues) {
-            csvFile << timestamp << "," << qmName << "," << q.queueName << "," << q.queueType << ","
-                    << q.currentDepth << "," << q.openInputCount << "," << q.openOutputCount << ","
-                    << q.connection << "," << q.channelName << "," << q.user << "," << q.processId << ","
-                    << q.applicationTag << "," << q.processType << "," << q.role << "\n";
-        }
-        csvFile.close();
-        logger.info("CSV data appended to: " + csvPath);
-    } catch (const exception& e) {
-        logger.error("Error generating CSV: " + string(e.what()));
+    logger.log("========================================");
+    if (partialResults > 0) {
+        logger.warning("Operation completed with {} partial status result(s)", partialResults.load());
+    } else {
+        logger.info("Operation completed successfully");
     }
+    return 0;
 }
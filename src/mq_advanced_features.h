@@ -116,43 +116,7 @@ namespace MQAdvanced {
         }
     };
 
-    /**
-     * Connection pooling and session management
-     */
-    class ConnectionPool {
-    private:
-        std::vector<MQHCONN> connections;
-        size_t maxConnections;
-
-    public:
-        ConnectionPool(size_t max) : maxConnections(max) {}
-
-        MQHCONN getConnection()
-        {
-            if (!connections.empty()) {
-                MQHCONN conn = connections.back();
-                connections.pop_back();
-                return conn;
-            }
-            return MQHC_UNUSABLE_HCONN;
-        }
-
-        void returnConnection(MQHCONN conn)
-        {
-            if (connections.size() < maxConnections) {
-                connections.push_back(conn);
-            }
-        }
-
-        void closeAll()
-        {
-            MQLONG compCode, reason;
-            for (auto conn : connections) {
-                MQDISC(&conn, &compCode, &reason);
-            }
-            connections.clear();
-        }
-    };
+    // Connection pooling: see MQConnectionPool in mq_connection_pool.h
 
 } // namespace MQAdvanced
 
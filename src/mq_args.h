@@ -21,6 +21,13 @@ struct CommandLineArgs {
     string inputFile = "";       // Text file with QM names for batch processing
     int logSizeMB = 10;         // Log file size in MB
     int maxLogBackups = 5;      // Max number of log backups
+    string queueFilter = "";     // Generic queue names to inquire (overrides config)
+    string statusFilter = "";    // Server-side integer filter (overrides config)
+    bool streaming = false;      // Emit rows as replies arrive (overrides config)
+    bool asyncReplies = false;   // Consume replies with MQCB callbacks (overrides config)
+    bool daemon = false;         // Keep running and poll each QM on its interval
+    string dumpFile = "";        // Snapshot file to print as CSV, then exit
+    string decodeLogFile = "";   // Binary log file to print as text, then exit
 
     /**
      * Display help message
@@ -30,7 +37,7 @@ struct CommandLineArgs {
         cout << "\nUsage: " << programName << " --config <file> --qm <qm_name> [OPTIONS]" << endl;
         cout << "\nRequired Arguments:" << endl;
         cout << "  --config <file>       Path to TOML configuration file (must contain QM)" << endl;
-        cout << "  --qm <name>           Queue manager name (must exist in TOML config)" << endl;
+        cout << "  --qm <name>           Queue manager name (must exist in TOML config), or a pattern like 'PROD_*'" << endl;
         cout << "\nOperation Flags:" << endl;
         cout << "  --status              Get status of all local queues (default)" << endl;
         cout << "  --queue <name>        Specify queue name for GET/PUT operations" << endl;
@@ -40,11 +47,21 @@ struct CommandLineArgs {
         cout << "  --input-file <file>   Text file with queue manager names (batch mode)" << endl;
         cout << "  --log-size <MB>       Max log file size in MB (default 10)" << endl;
         cout << "  --log-backups <num>   Number of log backups to keep (default 5)" << endl;
+        cout << "  --queue-filter <list> Comma-separated generic queue names, e.g. \"APP*,ORDERS.*\"" << endl;
+        cout << "  --status-filter <f>   Server-side filter, e.g. \"CURDEPTH GT 0\" or \"OPPROCS GT 0\"" << endl;
+        cout << "  --stream              Print rows as replies arrive instead of sorted by queue" << endl;
+        cout << "  --async               Consume PCF replies asynchronously (many QMs per thread)" << endl;
+        cout << "  --daemon              Keep running, polling each QM every poll_interval_sec" << endl;
+        cout << "  --dump <file>         Print a snapshot file as CSV (--qm optional, selects one QM)" << endl;
+        cout << "  --decode-log <file>   Print a binary log file (log_format = \"binary\") as text" << endl;
         cout << "  --help                Show this help message" << endl;
         cout << "\nExamples:" << endl;
         cout << "  " << programName << " --config config.toml --qm default --status" << endl;
+        cout << "  " << programName << " --config config.toml --qm 'PROD_*' --status" << endl;
         cout << "  " << programName << " --config config.toml --qm default --queue APP1.REQ --get" << endl;
         cout << "  " << programName << " --config config.toml --qm default --queue APP1.REQ --put" << endl;
+        cout << "  " << programName << " --dump snapshots/queue_status_20250101_120000.mqsnap > status.csv" << endl;
+        cout << "  " << programName << " --decode-log logs/MQQStatusTool_20250101_120000.mqlog > status.log" << endl;
         cout << "\n";
     }
 
@@ -105,6 +122,35 @@ struct CommandLineArgs {
                     args.maxLogBackups = stoi(argv[++i]);
                 }
             }
+            else if (arg == "--queue-filter") {
+                if (i + 1 < argc) {
+                    args.queueFilter = argv[++i];
+                }
+            }
+            else if (arg == "--status-filter") {
+                if (i + 1 < argc) {
+                    args.statusFilter = argv[++i];
+                }
+            }
+            else if (arg == "--stream") {
+                args.streaming = true;
+            }
+            else if (arg == "--async") {
+                args.asyncReplies = true;
+            }
+            else if (arg == "--daemon") {
+                args.daemon = true;
+            }
+            else if (arg == "--dump") {
+                if (i + 1 < argc) {
+                    args.dumpFile = argv[++i];
+                }
+            }
+            else if (arg == "--decode-log") {
+                if (i + 1 < argc) {
+                    args.decodeLogFile = argv[++i];
+                }
+            }
         }
 
         // Default to status if no operation specified
@@ -0,0 +1,248 @@
+#ifndef MQ_ASYNC_ENGINE_H
+#define MQ_ASYNC_ENGINE_H
+
+#include <cmqc.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include "mq_log.h"
+#include "mq_connection_pool.h"
+#include "mq_pcf_session.h"
+#include "mq_pcf_status_inquirer.h"
+#include "mq_thread_pool.h"
+
+/**
+ * One queue manager's status poll run by MQAsyncPCFEngine. The poll holds the
+ * lease on its connection (and session) and its inquirer; the connection goes
+ * back to the pool once onComplete has consumed the rows.
+ */
+struct AsyncStatusPoll {
+    std::string qmName;
+    MQConnectionLease lease;
+    std::unique_ptr<MQPCFStatusInquirer> inquirer;
+
+    // Runs on a worker of the engine's pool once every reply arrived or the deadline passed
+    std::function<void(AsyncStatusPoll&)> onComplete;
+
+    // Engine state
+    class MQAsyncPCFEngine* engine = nullptr;
+    bool consuming = false;     // MQCB registered and MQCTL started
+    bool answered = false;      // Every inquiry saw its last reply, or consumption failed
+    MQLONG consumerFailure = MQRC_NONE;     // Invalidates the session once the consumer is stopped
+};
+
+/**
+ * Async PCF Engine - Collects PCF replies through MQCB message consumers
+ *
+ * A blocking poll keeps a thread in MQGET until the slowest reply of its
+ * queue manager arrives, so a worker serves one queue manager at a time.
+ * Here a poll only puts its inquiries and registers a consumer on its reply
+ * queue; the MQ client delivers each reply to onMessage() as it arrives and
+ * no application thread waits on a queue manager. A single completion thread
+ * stops the consumer of each poll that is answered (or whose deadline has
+ * passed) and posts the poll to the thread pool, whose workers turn the
+ * replies into rows and report them, several queue managers at a time. The
+ * fleet therefore takes about as long as its slowest queue manager, whatever
+ * the number of worker threads that connect and submit.
+ *
+ * Polls on a shared (permanent) reply queue are not accepted: a consumer
+ * cannot match several CorrelIds, so those use the blocking poll.
+ */
+class MQAsyncPCFEngine {
+private:
+    MQLog& logger;
+    ThreadPool* pool;           // Runs onComplete; the completion thread does without one
+    TaskGroup reports;          // onComplete calls posted to pool
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::unique_ptr<AsyncStatusPoll>> polls;
+    std::thread completionThread;
+    bool closed = false;
+    size_t submittedCount = 0;
+    size_t timedOutCount = 0;
+
+    // Message consumer; runs on the MQ client's dispatch thread of the poll's connection
+    static void MQENTRY onMessage(MQHCONN hConn, PMQVOID msgDesc, PMQVOID getMsgOpts,
+                                  PMQVOID buffer, PMQCBC context) {
+        (void)hConn;
+        (void)getMsgOpts;
+        AsyncStatusPoll* poll = (AsyncStatusPoll*)context->CallbackArea;
+        if (!poll) return;
+        MQAsyncPCFEngine& engine = *poll->engine;
+
+        bool answered = false;
+        if (context->CallType == MQCBCT_MSG_REMOVED && context->CompCode != MQCC_FAILED) {
+            answered = poll->inquirer->deliverReply(*(MQMD*)msgDesc, (const unsigned char*)buffer,
+                                                    context->DataLength);
+        } else if (context->CompCode == MQCC_FAILED) {
+            // The consumer cannot continue (connection broken, queue manager stopping, ...)
+            engine.logger.errorFor(poll->qmName, context->Reason, "Reply consumer for {} failed (Reason: {})",
+                                   poll->qmName, context->Reason);
+            poll->consumerFailure = context->Reason;
+            answered = true;
+        }
+
+        if (answered) {
+            std::lock_guard<std::mutex> guard(engine.mutex);
+            poll->answered = true;
+            engine.changed.notify_all();
+        }
+    }
+
+    // Register the reply consumer and start delivery; false if MQ refused either
+    bool startConsumer(AsyncStatusPoll& poll) {
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+        MQHCONN hConn = poll.lease.session().connection();
+
+        MQCBD callbackDesc = {MQCBD_DEFAULT};
+        callbackDesc.CallbackType = MQCBT_MESSAGE_CONSUMER;
+        callbackDesc.CallbackFunction = (MQPTR)onMessage;
+        callbackDesc.CallbackArea = &poll;
+        callbackDesc.MaxMsgLength = MQCBD_FULL_MSG_LENGTH;
+
+        MQMD msgDesc = {MQMD_DEFAULT};
+        MQGMO getMsgOpts = {MQGMO_DEFAULT};
+        getMsgOpts.Version = MQGMO_VERSION_2;
+        getMsgOpts.Options = MQGMO_NO_SYNCPOINT | MQGMO_CONVERT;
+        getMsgOpts.MatchOptions = MQMO_NONE;
+
+        MQCB(hConn, MQOP_REGISTER, &callbackDesc, poll.lease.session().replyQueue(),
+             &msgDesc, &getMsgOpts, &compCode, &reason);
+        if (compCode == MQCC_FAILED) {
+            logger.errorFor(poll.qmName, reason, "Failed to register reply consumer for {} (Reason: {})",
+                            poll.qmName, reason);
+            return false;
+        }
+
+        MQCTLO controlOpts = {MQCTLO_DEFAULT};
+        MQCTL(hConn, MQOP_START, &controlOpts, &compCode, &reason);
+        if (compCode == MQCC_FAILED) {
+            logger.errorFor(poll.qmName, reason, "Failed to start reply consumer for {} (Reason: {})",
+                            poll.qmName, reason);
+            MQCB(hConn, MQOP_DEREGISTER, &callbackDesc, poll.lease.session().replyQueue(),
+                 &msgDesc, &getMsgOpts, &compCode, &reason);
+            return false;
+        }
+        return true;
+    }
+
+    // Stop delivery; MQCTL STOP returns only after a running callback has finished
+    void stopConsumer(AsyncStatusPoll& poll) {
+        if (!poll.consuming) return;
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+        MQHCONN hConn = poll.lease.session().connection();
+
+        MQCTLO controlOpts = {MQCTLO_DEFAULT};
+        MQCTL(hConn, MQOP_STOP, &controlOpts, &compCode, &reason);
+
+        MQCBD callbackDesc = {MQCBD_DEFAULT};
+        MQCB(hConn, MQOP_DEREGISTER, &callbackDesc, poll.lease.session().replyQueue(),
+             nullptr, nullptr, &compCode, &reason);
+        poll.consuming = false;
+    }
+
+    // Report a stopped poll on the pool, so the completion thread only ever stops consumers
+    void complete(std::unique_ptr<AsyncStatusPoll> poll) {
+        if (!poll->onComplete) return;
+        if (pool) {
+            AsyncStatusPoll* posted = poll.release();
+            try {
+                pool->post(&reports, [posted] {
+                    std::unique_ptr<AsyncStatusPoll> owned(posted);
+                    owned->onComplete(*owned);
+                }, TaskPriority::High);
+                return;
+            } catch (const std::exception&) {
+                poll.reset(posted);     // The pool is stopping: report here
+            }
+        }
+        poll->onComplete(*poll);
+    }
+
+    // Completion thread: find polls that are answered or have run out of time
+    void completionLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!closed || !polls.empty()) {
+            auto now = std::chrono::steady_clock::now();
+            auto wakeAt = now + std::chrono::hours(1);
+            std::unique_ptr<AsyncStatusPoll> ready;
+
+            for (size_t i = 0; i < polls.size(); i++) {
+                auto deadline = polls[i]->inquirer->pollDeadline();
+                if (polls[i]->answered || deadline <= now) {
+                    if (!polls[i]->answered) timedOutCount++;
+                    ready = std::move(polls[i]);
+                    polls.erase(polls.begin() + i);
+                    break;
+                }
+                if (deadline < wakeAt) wakeAt = deadline;
+            }
+
+            if (!ready) {
+                changed.wait_until(lock, wakeAt);
+                continue;
+            }
+
+            lock.unlock();
+            stopConsumer(*ready);
+            // Not in the callback: invalidating closes the reply queue the consumer was registered on
+            if (ready->consumerFailure != MQRC_NONE) ready->lease.session().invalidate(ready->consumerFailure);
+            complete(std::move(ready));
+            lock.lock();
+        }
+    }
+
+public:
+    explicit MQAsyncPCFEngine(MQLog& log, ThreadPool* reportPool = nullptr) : logger(log), pool(reportPool) {
+        completionThread = std::thread([this] { completionLoop(); });
+    }
+
+    ~MQAsyncPCFEngine() { drain(); }
+
+    MQAsyncPCFEngine(const MQAsyncPCFEngine&) = delete;
+    MQAsyncPCFEngine& operator=(const MQAsyncPCFEngine&) = delete;
+
+    // Polls on a shared reply queue must use the blocking path
+    static bool supports(const MQPCFSession& session) { return !session.sharedReplyQueue(); }
+
+    /**
+     * Start a poll: put its inquiries and register its reply consumer, then
+     * return without waiting. May be called from any thread. A poll that
+     * cannot be started still completes (with no rows, flagged partial).
+     */
+    void submit(std::unique_ptr<AsyncStatusPoll> poll) {
+        poll->engine = this;
+        if (poll->inquirer->startAsyncPoll()) {
+            poll->consuming = startConsumer(*poll);
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        submittedCount++;
+        if (!poll->consuming) poll->answered = true;
+        polls.push_back(std::move(poll));
+        changed.notify_all();
+    }
+
+    // Wait until every submitted poll is complete; no polls may be submitted afterwards
+    void drain() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (closed) return;
+            closed = true;
+            changed.notify_all();
+        }
+        if (completionThread.joinable()) completionThread.join();
+        reports.wait();
+        logger.info("Async PCF engine completed {} poll(s), {} at their deadline",
+                    submittedCount, timedOutCount);
+    }
+};
+
+#endif // MQ_ASYNC_ENGINE_H
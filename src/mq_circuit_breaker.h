@@ -0,0 +1,159 @@
+#ifndef MQ_CIRCUIT_BREAKER_H
+#define MQ_CIRCUIT_BREAKER_H
+
+#include <cmqc.h>
+#include <string>
+#include <map>
+#include <mutex>
+#include <random>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include "mq_log.h"
+
+/**
+ * Circuit Breaker - Stops connecting to queue managers that keep failing
+ *
+ * Connecting to a stopped queue manager costs a full client connect timeout,
+ * which holds a worker (and a slot of its host) for nothing. After
+ * failureThreshold consecutive failures the queue manager's circuit opens
+ * and connections are not attempted until its retry time. The wait doubles
+ * with every further failure, from baseBackoff up to maxBackoff, and the
+ * actual wait is a random value between half and all of it (so a fleet that
+ * went down together is not retried all at once). When the retry time
+ * passes, one attempt is let through; success closes the circuit, failure
+ * opens it again for longer.
+ *
+ * Retry times are wall-clock, so the state survives between one-shot runs
+ * in a small text file as well as between polls of a daemon.
+ */
+class MQCircuitBreaker {
+private:
+    struct Health {
+        int failures = 0;           // Consecutive failed connects
+        time_t retryAt = 0;         // Circuit open until then; 0 while closed
+        MQLONG lastReason = MQRC_NONE;
+        bool trial = false;         // The one attempt let through after retryAt is running
+    };
+
+    MQLog& logger;
+    int failureThreshold;
+    int baseBackoffSec;
+    int maxBackoffSec;
+    std::mutex mutex;
+    std::mt19937 random;
+    std::unordered_map<std::string, Health> health;
+    std::map<std::string, size_t> skippedCounts;
+
+    static std::string formatTime(time_t when) {
+        struct tm timeinfo;
+#ifdef _WIN32
+        localtime_s(&timeinfo, &when);
+#else
+        localtime_r(&when, &timeinfo);
+#endif
+        std::ostringstream oss;
+        oss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
+        return oss.str();
+    }
+
+    // Backoff before the next attempt: base * 2^(failures past the threshold), capped, then jittered
+    int backoffFor(int failures) {
+        long long backoff = baseBackoffSec;
+        for (int i = failureThreshold; i < failures && backoff < maxBackoffSec; i++) backoff *= 2;
+        backoff = std::min<long long>(backoff, maxBackoffSec);
+        std::uniform_int_distribution<long long> jitter(0, backoff / 2);
+        return (int)(backoff / 2 + jitter(random));
+    }
+
+public:
+    MQCircuitBreaker(MQLog& log, int threshold = 3, int baseBackoff = 30, int maxBackoff = 1800)
+        : logger(log), failureThreshold(std::max(1, threshold)), baseBackoffSec(std::max(1, baseBackoff)),
+          maxBackoffSec(std::max(baseBackoff, maxBackoff)), random(std::random_device{}()) {}
+
+    /**
+     * True if a connection to name may be attempted now. A queue manager
+     * whose circuit is open is logged and counted as skipped.
+     */
+    bool allow(const std::string& name) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = health.find(name);
+        if (it == health.end() || it->second.retryAt == 0) return true;
+
+        Health& state = it->second;
+        if (time(0) >= state.retryAt && !state.trial) {
+            state.trial = true;
+            logger.info("Circuit for {} is half-open, trying one connection", name);
+            return true;
+        }
+        skippedCounts[name]++;
+        logger.warningFor(name, state.lastReason,
+                          "Skipped {}: circuit open after {} consecutive failure(s) (last Reason: {}), next attempt after {}",
+                          name, state.failures, state.lastReason, formatTime(state.retryAt));
+        return false;
+    }
+
+    void recordSuccess(const std::string& name) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = health.find(name);
+        if (it == health.end()) return;
+        if (it->second.retryAt != 0) {
+            logger.info("Circuit for {} closed, queue manager reachable again", name);
+        }
+        health.erase(it);
+    }
+
+    void recordFailure(const std::string& name, MQLONG reason) {
+        std::lock_guard<std::mutex> guard(mutex);
+        Health& state = health[name];
+        state.failures++;
+        state.lastReason = reason;
+        state.trial = false;
+        if (state.failures < failureThreshold) return;
+
+        int backoff = backoffFor(state.failures);
+        state.retryAt = time(0) + backoff;
+        logger.warning("Circuit for {} open after {} consecutive failure(s), next attempt in {} s",
+                       name, state.failures, backoff);
+    }
+
+    // Times each queue manager was skipped since construction
+    std::map<std::string, size_t> skipped() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return skippedCounts;
+    }
+
+    // Missing or unreadable files just mean every circuit is closed
+    void load(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::lock_guard<std::mutex> guard(mutex);
+        while (getline(in, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            Health state;
+            long long retryAt = 0;
+            if (fields >> name >> state.failures >> retryAt >> state.lastReason && state.failures > 0) {
+                state.retryAt = (time_t)retryAt;
+                health[name] = state;
+            }
+        }
+    }
+
+    // One line per queue manager that is failing: "NAME failures retryAt reason"
+    bool save(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        std::lock_guard<std::mutex> guard(mutex);
+        for (const auto& entry : health) {
+            out << entry.first << " " << entry.second.failures << " " << (long long)entry.second.retryAt
+                << " " << entry.second.lastReason << "\n";
+        }
+        return out.good();
+    }
+};
+
+#endif // MQ_CIRCUIT_BREAKER_H
@@ -2,10 +2,25 @@
 #define MQ_CONFIGURATION_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <fstream>
-#include <sstream>
+#include <unordered_map>
 #include <iostream>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 struct QMConfig {
     std::string sectionName;     // [queuemanager.NAME] - the NAME part
@@ -14,35 +29,236 @@ struct QMConfig {
     std::string port;
     std::string channel;
     std::string queueName;
+    std::string queueFilter;     // Overrides [global] queue_filter when set
+    std::string statusFilter;    // Overrides [global] status_filter when set
+    std::string replyQueue;      // PCF reply queue: predefined name, or dynamic prefix ending in '*'
+    int inquiryTimeoutMs = 0;    // Overrides [global] inquiry_timeout_ms when set
+    int pollIntervalSec = 0;     // Overrides [global] poll_interval_sec when set
 };
 
 struct GlobalConfig {
     std::string logPath;
     int logSizeMB;
     int logBackups;
+    int logQueueSize;            // Lines the async logger holds before the overflow policy applies
+    std::string logOverflow;     // "block", "drop" or "count"
+    std::string logLevel;        // "trace", "debug", "info", "warning" or "error"
+    std::string logFormat;       // "text", or "binary" for a compact log read with --decode-log
+    int logRepeatLimit;          // Lines per format and reason code per interval from errorFor(); 0 = no limit
+    int logRepeatIntervalSec;    // Interval of logRepeatLimit; suppressed lines are summarised after it
     bool generateCSV;
     std::string csvPath;
+    bool generateSnapshot;       // Also write each poll to a binary snapshot file
+    std::string snapshotPath;
     int maxThreads;
+    std::string queueFilter;     // Generic queue names pushed to the command server
+    std::string statusFilter;    // Integer condition, e.g. "CURDEPTH GT 0"
+    bool streaming;              // Emit rows as handle-level replies arrive
+    int inquiryTimeoutMs;        // End-to-end budget of one status poll
+    bool asyncReplies;           // Consume PCF replies with MQCB callbacks
+    int pollIntervalSec;         // Daemon: time between polls of a queue manager
+    int pollJitterPct;           // Daemon: random shift of each poll, % of its interval
+    int rollIntervalMin;         // Daemon: log and CSV files start anew at multiples of this
+    int maxPerHost;              // Queue managers of one host processed at the same time
+    std::string durationHistoryPath;  // Last run's duration per queue manager, for job ordering
+    int breakerFailures;         // Consecutive connect failures that open a queue manager's circuit
+    int breakerBackoffSec;       // First wait before retrying an open circuit; doubles per failure
+    int breakerMaxBackoffSec;    // Longest wait before retrying an open circuit
+    std::string healthStatePath; // Circuit state kept between runs
 };
 
+/**
+ * Configuration loader
+ *
+ * The file is mapped and parsed in place: lines, keys and values are
+ * string_views into the mapping, and only the values kept are copied.
+ * Queue managers are indexed by section name and by queue_manager, so
+ * looking one up costs a hash lookup however large the inventory; names
+ * with '*' or '?' select every queue manager whose section name or
+ * queue_manager matches (see findQueueManagers()).
+ */
 class MQConfiguration {
 private:
     GlobalConfig globalConfig;
     std::vector<QMConfig> queueManagers;
+    std::unordered_map<std::string_view, size_t> bySection;    // Views into queueManagers
+    std::unordered_map<std::string_view, size_t> byName;
 
-    std::string trim(const std::string& str) {
+    // Read-only mapping of a whole file
+    class MappedFile {
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // False if the file cannot be opened; an empty file maps to an empty view
+        bool open(const std::string& path) {
+#ifdef _WIN32
+            fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (fileHandle == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx(fileHandle, &fileSize);
+            size = (size_t)fileSize.QuadPart;
+            if (size == 0) return true;
+            mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!data) {
+                close();
+                return false;
+            }
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat info;
+            if (fstat(fd, &info) != 0) {
+                ::close(fd);
+                return false;
+            }
+            size = (size_t)info.st_size;
+            if (size == 0) {
+                ::close(fd);
+                return true;
+            }
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED) {
+                size = 0;
+                return false;
+            }
+            data = (const char*)mapped;
+#endif
+            return true;
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+            mapping = nullptr;
+            fileHandle = INVALID_HANDLE_VALUE;
+#else
+            if (data) munmap((void*)data, size);
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        std::string_view text() const { return std::string_view(data ? data : "", size); }
+    };
+
+    static std::string_view trim(std::string_view str) {
         size_t first = str.find_first_not_of(" \t\r\n");
-        if (first == std::string::npos) return "";
+        if (first == std::string_view::npos) return std::string_view();
         size_t last = str.find_last_not_of(" \t\r\n");
-        return str.substr(first, (last - first + 1));
+        return str.substr(first, last - first + 1);
+    }
+
+    static std::string_view removeQuotes(std::string_view str) {
+        if (!str.empty() && str.front() == '"') str.remove_prefix(1);
+        if (!str.empty() && str.back() == '"') str.remove_suffix(1);
+        return str;
+    }
+
+    // False, leaving target alone, unless value is a whole number
+    static bool toInt(std::string_view value, int& target) {
+        int parsed = 0;
+        auto result = std::from_chars(value.data(), value.data() + value.size(), parsed);
+        if (result.ec != std::errc() || result.ptr != value.data() + value.size()) return false;
+        target = parsed;
+        return true;
+    }
+
+    // Unknown keys are ignored; false if a number is malformed
+    bool setGlobal(std::string_view key, std::string_view value) {
+        if (key == "log_file_path") globalConfig.logPath = value;
+        else if (key == "log_file_size_mb") return toInt(value, globalConfig.logSizeMB);
+        else if (key == "log_backups") return toInt(value, globalConfig.logBackups);
+        else if (key == "log_queue_size") return toInt(value, globalConfig.logQueueSize);
+        else if (key == "log_overflow") globalConfig.logOverflow = value;
+        else if (key == "log_level") globalConfig.logLevel = value;
+        else if (key == "log_format") globalConfig.logFormat = value;
+        else if (key == "log_repeat_limit") return toInt(value, globalConfig.logRepeatLimit);
+        else if (key == "log_repeat_interval_sec") return toInt(value, globalConfig.logRepeatIntervalSec);
+        else if (key == "generate_csv") globalConfig.generateCSV = (value == "true");
+        else if (key == "csv_file_path") globalConfig.csvPath = value;
+        else if (key == "generate_snapshot") globalConfig.generateSnapshot = (value == "true");
+        else if (key == "snapshot_file_path") globalConfig.snapshotPath = value;
+        else if (key == "max_threads") return toInt(value, globalConfig.maxThreads);
+        else if (key == "queue_filter") globalConfig.queueFilter = value;
+        else if (key == "status_filter") globalConfig.statusFilter = value;
+        else if (key == "streaming") globalConfig.streaming = (value == "true");
+        else if (key == "inquiry_timeout_ms") return toInt(value, globalConfig.inquiryTimeoutMs);
+        else if (key == "async_replies") globalConfig.asyncReplies = (value == "true");
+        else if (key == "poll_interval_sec") return toInt(value, globalConfig.pollIntervalSec);
+        else if (key == "poll_jitter_pct") return toInt(value, globalConfig.pollJitterPct);
+        else if (key == "roll_interval_min") return toInt(value, globalConfig.rollIntervalMin);
+        else if (key == "max_per_host") return toInt(value, globalConfig.maxPerHost);
+        else if (key == "duration_history_file") globalConfig.durationHistoryPath = value;
+        else if (key == "breaker_failures") return toInt(value, globalConfig.breakerFailures);
+        else if (key == "breaker_backoff_sec") return toInt(value, globalConfig.breakerBackoffSec);
+        else if (key == "breaker_max_backoff_sec") return toInt(value, globalConfig.breakerMaxBackoffSec);
+        else if (key == "health_state_file") globalConfig.healthStatePath = value;
+        return true;
+    }
+
+    static bool setQueueManager(QMConfig& qm, std::string_view key, std::string_view value) {
+        if (key == "queue_manager") qm.queueManager = value;
+        else if (key == "host") qm.host = value;
+        else if (key == "port") qm.port = value;
+        else if (key == "channel") qm.channel = value;
+        else if (key == "queue_name") qm.queueName = value;
+        else if (key == "queue_filter") qm.queueFilter = value;
+        else if (key == "status_filter") qm.statusFilter = value;
+        else if (key == "reply_queue") qm.replyQueue = value;
+        else if (key == "inquiry_timeout_ms") return toInt(value, qm.inquiryTimeoutMs);
+        else if (key == "poll_interval_sec") return toInt(value, qm.pollIntervalSec);
+        return true;
+    }
+
+    // The first section (and the first queue_manager) of a name wins, as it did with a linear search
+    void buildIndexes() {
+        bySection.clear();
+        byName.clear();
+        bySection.reserve(queueManagers.size());
+        byName.reserve(queueManagers.size());
+        for (size_t i = 0; i < queueManagers.size(); i++) {
+            bySection.emplace(queueManagers[i].sectionName, i);
+            if (!queueManagers[i].queueManager.empty()) byName.emplace(queueManagers[i].queueManager, i);
+        }
     }
 
-    std::string removeQuotes(const std::string& str) {
-        std::string result = str;
-        if (!result.empty() && result[0] == '"') result = result.substr(1);
-        if (!result.empty() && result[result.length() - 1] == '"')
-            result = result.substr(0, result.length() - 1);
-        return result;
+    // '*' matches any run of characters, '?' any one character
+    static bool globMatch(std::string_view pattern, std::string_view text) {
+        size_t p = 0, t = 0;
+        size_t star = std::string_view::npos, resume = 0;
+        while (t < text.size()) {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+                p++;
+                t++;
+            } else if (p < pattern.size() && pattern[p] == '*') {
+                star = p++;
+                resume = t;
+            } else if (star != std::string_view::npos) {
+                p = star + 1;
+                t = ++resume;
+            } else {
+                return false;
+            }
+        }
+        while (p < pattern.size() && pattern[p] == '*') p++;
+        return p == pattern.size();
     }
 
 public:
@@ -50,93 +266,132 @@ public:
         globalConfig.logPath = "MQQStatusTool.log";
         globalConfig.logSizeMB = 10;
         globalConfig.logBackups = 5;
+        globalConfig.logQueueSize = 8192;
+        globalConfig.logOverflow = "block";
+        globalConfig.logLevel = "info";
+        globalConfig.logFormat = "text";
+        globalConfig.logRepeatLimit = 5;
+        globalConfig.logRepeatIntervalSec = 60;
         globalConfig.generateCSV = true;
         globalConfig.csvPath = "queue_status.csv";
+        globalConfig.generateSnapshot = false;
+        globalConfig.snapshotPath = "queue_status.mqsnap";
         globalConfig.maxThreads = 5;
+        globalConfig.streaming = false;
+        globalConfig.inquiryTimeoutMs = 30000;
+        globalConfig.asyncReplies = false;
+        globalConfig.pollIntervalSec = 60;
+        globalConfig.pollJitterPct = 10;
+        globalConfig.rollIntervalMin = 60;
+        globalConfig.maxPerHost = 2;
+        globalConfig.durationHistoryPath = "poll_durations.txt";
+        globalConfig.breakerFailures = 3;
+        globalConfig.breakerBackoffSec = 30;
+        globalConfig.breakerMaxBackoffSec = 1800;
+        globalConfig.healthStatePath = "qm_health.txt";
     }
 
+    // The indexes refer to this object's strings
+    MQConfiguration(const MQConfiguration&) = delete;
+    MQConfiguration& operator=(const MQConfiguration&) = delete;
+
     bool loadFromFile(const std::string& filePath) {
-        std::ifstream file(filePath);
-        if (!file.is_open()) {
+        MappedFile file;
+        if (!file.open(filePath)) {
             std::cerr << "ERROR: Could not open config file: " << filePath << std::endl;
             return false;
         }
 
-        std::string line;
-        QMConfig currentQM;
+        queueManagers.clear();
+        std::string_view text = file.text();
+        size_t sections = 0;
+        for (size_t at = text.find("[queuemanager."); at != std::string_view::npos;
+             at = text.find("[queuemanager.", at + 1)) {
+            sections++;
+        }
+        queueManagers.reserve(sections);
+        QMConfig* currentQM = nullptr;
         bool inGlobalSection = false;
-        bool inQMSection = false;
+        size_t lineNumber = 0;
 
-        while (getline(file, line)) {
-            line = trim(line);
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos) end = text.size();
+            std::string_view line = trim(text.substr(pos, end - pos));
+            pos = end + 1;
+            lineNumber++;
 
             if (line.empty() || line[0] == '#' || line[0] == ';') continue;
 
-            if (line[0] == '[' && line[line.length() - 1] == ']') {
-                if (inQMSection && !currentQM.sectionName.empty()) {
-                    queueManagers.push_back(currentQM);
-                }
-                currentQM = QMConfig();
-
-                if (line == "[global]") {
-                    inGlobalSection = true;
-                    inQMSection = false;
-                } else if (line.find("[queuemanager.") == 0) {
-                    inGlobalSection = false;
-                    inQMSection = true;
+            if (line.front() == '[' && line.back() == ']') {
+                inGlobalSection = (line == "[global]");
+                currentQM = nullptr;
+                if (line.substr(0, 14) == "[queuemanager.") {
                     // Extract section name: [queuemanager.NAME] -> NAME
-                    size_t start = line.find('.') + 1;
-                    size_t end = line.rfind(']');
-                    currentQM.sectionName = line.substr(start, end - start);
+                    std::string_view name = line.substr(14, line.size() - 15);
+                    if (!name.empty()) {
+                        queueManagers.emplace_back();
+                        currentQM = &queueManagers.back();
+                        currentQM->sectionName = name;
+                    }
                 }
                 continue;
             }
 
             size_t eqPos = line.find('=');
-            if (eqPos == std::string::npos) continue;
-
-            std::string key = trim(line.substr(0, eqPos));
-            std::string value = trim(line.substr(eqPos + 1));
-            value = removeQuotes(value);
-
-            if (inGlobalSection) {
-                if (key == "log_file_path") globalConfig.logPath = value;
-                else if (key == "log_file_size_mb") globalConfig.logSizeMB = std::stoi(value);
-                else if (key == "log_backups") globalConfig.logBackups = std::stoi(value);
-                else if (key == "generate_csv") globalConfig.generateCSV = (value == "true");
-                else if (key == "csv_file_path") globalConfig.csvPath = value;
-                else if (key == "max_threads") globalConfig.maxThreads = std::stoi(value);
-            } else if (inQMSection) {
-                if (key == "queue_manager") currentQM.queueManager = value;
-                else if (key == "host") currentQM.host = value;
-                else if (key == "port") currentQM.port = value;
-                else if (key == "channel") currentQM.channel = value;
-                else if (key == "queue_name") currentQM.queueName = value;
-            }
-        }
+            if (eqPos == std::string_view::npos) continue;
 
-        if (inQMSection && !currentQM.sectionName.empty()) {
-            queueManagers.push_back(currentQM);
+            std::string_view key = trim(line.substr(0, eqPos));
+            std::string_view value = removeQuotes(trim(line.substr(eqPos + 1)));
+
+            bool valid = true;
+            if (inGlobalSection) valid = setGlobal(key, value);
+            else if (currentQM) valid = setQueueManager(*currentQM, key, value);
+            if (!valid) {
+                std::cerr << "ERROR: " << filePath << " line " << lineNumber << ": " << key
+                          << " must be a whole number, not: " << value << std::endl;
+                return false;
+            }
         }
 
-        file.close();
+        buildIndexes();
         return !queueManagers.empty();
     }
 
-    QMConfig getQueueManager(const std::string& name) {
-        // First try matching by section name (e.g., "default")
-        for (const auto& qm : queueManagers) {
-            if (qm.sectionName == name) {
-                return qm;
-            }
+    // The queue manager with this section name, else with this queue_manager; nullptr if none
+    const QMConfig* findQueueManager(std::string_view name) const {
+        auto it = bySection.find(name);
+        if (it != bySection.end()) return &queueManagers[it->second];
+        it = byName.find(name);
+        return it != byName.end() ? &queueManagers[it->second] : nullptr;
+    }
+
+    // Whether name is a pattern for findQueueManagers() rather than a single name
+    static bool isPattern(std::string_view name) {
+        return name.find_first_of("*?") != std::string_view::npos;
+    }
+
+    /**
+     * The queue managers selected by name: the one found by findQueueManager(),
+     * or for a pattern such as "PROD_*" every one whose section name or
+     * queue_manager matches, in file order.
+     */
+    std::vector<const QMConfig*> findQueueManagers(std::string_view name) const {
+        std::vector<const QMConfig*> found;
+        if (!isPattern(name)) {
+            if (const QMConfig* qm = findQueueManager(name)) found.push_back(qm);
+            return found;
         }
-        // Then try matching by queue manager name (e.g., "MQQM1")
         for (const auto& qm : queueManagers) {
-            if (qm.queueManager == name) {
-                return qm;
-            }
+            if (globMatch(name, qm.sectionName) || globMatch(name, qm.queueManager)) found.push_back(&qm);
         }
-        return QMConfig();
+        return found;
+    }
+
+    QMConfig getQueueManager(const std::string& name) const {
+        const QMConfig* qm = findQueueManager(name);
+        return qm ? *qm : QMConfig();
     }
 
     GlobalConfig getGlobalConfig() const { return globalConfig; }
@@ -144,4 +399,3 @@ public:
 };
 
 #endif // MQ_CONFIGURATION_H
-
@@ -18,6 +18,8 @@ private:
     MQHOBJ hQueue;
     MQLog& logger;
     bool isInputQueue;
+    bool reconnectable = false;
+    MQLONG lastReason = MQRC_NONE;
 
 public:
     MQConnection(MQLog& log) : logger(log), hConn(MQHC_UNUSABLE_HCONN),
@@ -38,8 +40,7 @@ public:
     }
 
     bool connect() {
-        logger.info("Connecting to queue manager: " + queueManager +
-                     " at " + host + "(" + port + ") channel=" + channel);
+        logger.debug("Connecting to queue manager: {} at {}({}) channel={}", queueManager, host, port, channel);
 
         MQLONG compCode = MQCC_OK;
         MQLONG reason = MQRC_NONE;
@@ -62,23 +63,28 @@ public:
         MQCNO connOpts = {MQCNO_DEFAULT};
         connOpts.Version = MQCNO_VERSION_2;
         connOpts.Options = MQCNO_CLIENT_BINDING;
+        if (reconnectable) {
+            // The client re-establishes a broken connection to the same queue manager
+            // and reopens its objects; MQI calls wait meanwhile
+            connOpts.Options |= MQCNO_RECONNECT_Q_MGR;
+        }
         connOpts.ClientConnPtr = &clientConn;
 
         MQCONNX((PMQCHAR)queueManager.c_str(), &connOpts, &hConn, &compCode, &reason);
+        lastReason = reason;
 
         if (compCode != MQCC_OK) {
-            logger.error("Failed to connect to " + queueManager +
-                         " Reason: " + std::to_string(reason) +
-                         " CompCode: " + std::to_string(compCode));
+            logger.errorFor(queueManager, reason, "Failed to connect to {} Reason: {} CompCode: {}",
+                            queueManager, reason, compCode);
             return false;
         }
 
-        logger.info("Connected successfully to " + queueManager);
+        logger.info("Connected successfully to {}", queueManager);
         return true;
     }
 
     bool openQueue(MQLONG openOptions = MQOO_INQUIRE) {
-        logger.info("Opening queue: " + queueName);
+        logger.debug("Opening queue: {}", queueName);
 
         MQOD queueDesc = {MQOD_DEFAULT};
         strncpy(queueDesc.ObjectName, queueName.c_str(), MQ_Q_NAME_LENGTH);
@@ -89,17 +95,54 @@ public:
         MQOPEN(hConn, &queueDesc, openOptions, &hQueue, &compCode, &reason);
 
         if (compCode != MQCC_OK) {
-            logger.error("Failed to open queue: " + queueName +
-                         " Reason: " + std::to_string(reason));
+            logger.error("Failed to open queue: {} Reason: {}", queueName, reason);
             return false;
         }
 
-        logger.info("Queue opened successfully");
+        logger.debug("Queue opened successfully");
         return true;
     }
 
     bool isInputOnly() const { return isInputQueue; }
 
+    // Ask the client to reconnect automatically (MQCNO_RECONNECT_Q_MGR); set before connect()
+    void setReconnect(bool enable) { reconnectable = enable; }
+
+    /**
+     * Check that the connection still reaches the queue manager with a cheap
+     * inquiry on the queue manager object. Returns false (and keeps the
+     * reason in getLastReason()) if it does not.
+     */
+    bool ping() {
+        if (hConn == MQHC_UNUSABLE_HCONN) return false;
+
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+
+        MQOD qmgrDesc = {MQOD_DEFAULT};
+        qmgrDesc.ObjectType = MQOT_Q_MGR;
+        MQHOBJ hQmgr = MQHO_UNUSABLE_HOBJ;
+        MQOPEN(hConn, &qmgrDesc, MQOO_INQUIRE | MQOO_FAIL_IF_QUIESCING, &hQmgr, &compCode, &reason);
+        if (compCode != MQCC_OK) {
+            lastReason = reason;
+            return false;
+        }
+
+        MQLONG selector = MQIA_COMMAND_LEVEL;
+        MQLONG commandLevel = 0;
+        MQINQ(hConn, hQmgr, 1, &selector, 1, &commandLevel, 0, NULL, &compCode, &reason);
+        lastReason = reason;
+        bool alive = compCode == MQCC_OK;
+
+        MQLONG closeCode = MQCC_OK;
+        MQLONG closeReason = MQRC_NONE;
+        MQCLOSE(hConn, &hQmgr, MQCO_NONE, &closeCode, &closeReason);
+        return alive;
+    }
+
+    bool isConnected() const { return hConn != MQHC_UNUSABLE_HCONN; }
+    MQLONG getLastReason() const { return lastReason; }
+
     void disconnect() {
         if (hQueue != MQHO_UNUSABLE_HOBJ) {
             MQLONG compCode = MQCC_OK;
@@ -113,7 +156,7 @@ public:
             MQLONG reason = MQRC_NONE;
             MQDISC(&hConn, &compCode, &reason);
             hConn = MQHC_UNUSABLE_HCONN;
-            logger.info("Disconnected from " + queueManager);
+            logger.info("Disconnected from {}", queueManager);
         }
     }
 
@@ -0,0 +1,281 @@
+#ifndef MQ_CONNECTION_POOL_H
+#define MQ_CONNECTION_POOL_H
+
+#include <cmqc.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include "mq_log.h"
+#include "mq_configuration.h"
+#include "mq_connection.h"
+#include "mq_pcf_session.h"
+
+/**
+ * A pooled connection with its PCF session (command and reply queues)
+ */
+struct PooledConnection {
+    std::string key;
+    std::unique_ptr<MQConnection> connection;
+    std::unique_ptr<MQPCFSession> session;
+    std::chrono::steady_clock::time_point lastUsed;
+    size_t uses = 0;
+};
+
+class MQConnectionPool;
+
+/**
+ * Exclusive use of a pooled connection. The connection goes back to the
+ * pool when the lease is destroyed, unless it was found broken.
+ */
+class MQConnectionLease {
+private:
+    MQConnectionPool* pool = nullptr;
+    std::unique_ptr<PooledConnection> entry;
+
+public:
+    MQConnectionLease() = default;
+    MQConnectionLease(MQConnectionPool* owner, std::unique_ptr<PooledConnection> pooled)
+        : pool(owner), entry(std::move(pooled)) {}
+
+    MQConnectionLease(MQConnectionLease&& other) noexcept
+        : pool(other.pool), entry(std::move(other.entry)) {}
+
+    MQConnectionLease& operator=(MQConnectionLease&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool = other.pool;
+            entry = std::move(other.entry);
+        }
+        return *this;
+    }
+
+    MQConnectionLease(const MQConnectionLease&) = delete;
+    MQConnectionLease& operator=(const MQConnectionLease&) = delete;
+
+    ~MQConnectionLease() { release(); }
+
+    explicit operator bool() const { return entry != nullptr; }
+
+    MQConnection& connection() { return *entry->connection; }
+    MQPCFSession& session() { return *entry->session; }
+    MQHCONN handle() const { return entry->connection->getHandle(); }
+
+    // True if this lease reuses a connection made for an earlier poll
+    bool reused() const { return entry && entry->uses > 1; }
+
+    // Hand the connection back now (defined after MQConnectionPool)
+    void release();
+};
+
+/**
+ * Connection Pool - Long-lived connections keyed by queue manager
+ *
+ * MQCONNX costs a TCP (and possibly TLS) handshake plus authentication, and a
+ * fresh connection also has to open its command and reply queues. The pool
+ * keeps connections, each with its MQPCFSession, between polls of the same
+ * queue manager, so steady-state polls skip all of that. acquire() is safe to
+ * call from any worker; a connection is leased to one worker at a time.
+ *
+ * Connections are made with MQCNO_RECONNECT_Q_MGR, so the client itself
+ * rides out a short outage. A connection that has been idle for a while is
+ * pinged before it is handed out, and one that reports a broken connection
+ * (or whose session was invalidated for that reason) is disconnected instead
+ * of being returned; either way the next acquire() reconnects, so callers
+ * never see a dead handle twice.
+ */
+class MQConnectionPool {
+private:
+    friend class MQConnectionLease;
+
+    MQLog& logger;
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<PooledConnection>>> idle;
+    size_t maxIdlePerQM;
+    std::chrono::seconds idleTimeout;
+    std::chrono::seconds healthCheckAfter;
+
+    // Counters since construction
+    size_t connects = 0;
+    size_t reuses = 0;
+    size_t healthCheckFailures = 0;
+    size_t brokenDiscarded = 0;
+
+    static std::string keyFor(const QMConfig& qm) {
+        return qm.queueManager + "@" + qm.host + "(" + qm.port + ")/" + qm.channel + "/" + qm.replyQueue;
+    }
+
+    void disconnect(std::unique_ptr<PooledConnection>& pooled) {
+        pooled->session.reset();      // Close the queues before the connection goes
+        pooled->connection->disconnect();
+        pooled.reset();
+    }
+
+    // Disconnect idle connections nobody used within idleTimeout; caller holds the mutex
+    void expireIdle(std::chrono::steady_clock::time_point now,
+                    std::vector<std::unique_ptr<PooledConnection>>& expired) {
+        for (auto& entry : idle) {
+            auto& list = entry.second;
+            for (size_t i = 0; i < list.size();) {
+                if (now - list[i]->lastUsed > idleTimeout) {
+                    expired.push_back(std::move(list[i]));
+                    list.erase(list.begin() + i);
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+
+    void giveBack(std::unique_ptr<PooledConnection> pooled) {
+        MQLONG failure = pooled->session->failureReason();
+        if (isConnectionFatal(failure) || !pooled->connection->isConnected()) {
+            std::string name = pooled->connection->getQueueManagerName();
+            logger.warningFor(name, failure, "Dropping broken connection to {} (Reason: {})", name, failure);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                brokenDiscarded++;
+            }
+            disconnect(pooled);
+            return;
+        }
+
+        pooled->lastUsed = std::chrono::steady_clock::now();
+        std::unique_ptr<PooledConnection> surplus;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto& list = idle[pooled->key];
+            if (list.size() < maxIdlePerQM) {
+                list.push_back(std::move(pooled));
+            } else {
+                surplus = std::move(pooled);
+            }
+        }
+        if (surplus) disconnect(surplus);
+    }
+
+public:
+    MQConnectionPool(MQLog& log, size_t maxIdle = 2,
+                     std::chrono::seconds idleLimit = std::chrono::seconds(600),
+                     std::chrono::seconds checkAfter = std::chrono::seconds(30))
+        : logger(log), maxIdlePerQM(maxIdle), idleTimeout(idleLimit), healthCheckAfter(checkAfter) {}
+
+    ~MQConnectionPool() { closeAll(); }
+
+    MQConnectionPool(const MQConnectionPool&) = delete;
+    MQConnectionPool& operator=(const MQConnectionPool&) = delete;
+
+    // Reasons after which the connection itself cannot be used again
+    static bool isConnectionFatal(MQLONG reason) {
+        switch (reason) {
+            case MQRC_CONNECTION_BROKEN:
+            case MQRC_HCONN_ERROR:
+            case MQRC_Q_MGR_NOT_AVAILABLE:
+            case MQRC_Q_MGR_QUIESCING:
+            case MQRC_Q_MGR_STOPPING:
+            case MQRC_CONNECTION_QUIESCING:
+            case MQRC_RECONNECT_FAILED:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Lease a connection to qm: an idle pooled one if it still answers,
+     * otherwise a new one. Returns an empty lease if the queue manager cannot
+     * be reached, with the MQCONNX reason in *failureReason if given.
+     */
+    MQConnectionLease acquire(const QMConfig& qm, MQLONG* failureReason = nullptr) {
+        std::string key = keyFor(qm);
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<PooledConnection>> expired;
+        std::unique_ptr<PooledConnection> pooled;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            expireIdle(now, expired);
+            auto it = idle.find(key);
+            if (it != idle.end() && !it->second.empty()) {
+                pooled = std::move(it->second.back());
+                it->second.pop_back();
+            }
+        }
+        for (auto& stale : expired) disconnect(stale);
+
+        if (pooled && now - pooled->lastUsed > healthCheckAfter && !pooled->connection->ping()) {
+            MQLONG reason = pooled->connection->getLastReason();
+            logger.warningFor(qm.queueManager, reason,
+                              "Pooled connection to {} failed its health check (Reason: {}), reconnecting",
+                              qm.queueManager, reason);
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                healthCheckFailures++;
+            }
+            disconnect(pooled);
+        }
+
+        if (pooled) {
+            pooled->uses++;
+            {
+                std::lock_guard<std::mutex> guard(mutex);
+                reuses++;
+            }
+            logger.info("Reusing pooled connection to {} (use {})", qm.queueManager, pooled->uses);
+            return MQConnectionLease(this, std::move(pooled));
+        }
+
+        pooled.reset(new PooledConnection());
+        pooled->key = key;
+        pooled->connection.reset(new MQConnection(logger));
+        pooled->connection->setConnectionDetails(qm.queueManager, qm.host, qm.port, qm.channel, qm.queueName);
+        pooled->connection->setReconnect(true);
+        if (!pooled->connection->connect()) {
+            if (failureReason) *failureReason = pooled->connection->getLastReason();
+            return MQConnectionLease();
+        }
+
+        pooled->session.reset(new MQPCFSession(logger, pooled->connection->getHandle(), qm.replyQueue));
+        pooled->uses = 1;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            connects++;
+        }
+        return MQConnectionLease(this, std::move(pooled));
+    }
+
+    // Number of idle connections held for all queue managers
+    size_t idleCount() {
+        std::lock_guard<std::mutex> guard(mutex);
+        size_t count = 0;
+        for (const auto& entry : idle) count += entry.second.size();
+        return count;
+    }
+
+    void logStats() {
+        std::lock_guard<std::mutex> guard(mutex);
+        logger.info("Connection pool: {} connect(s), {} reuse(s), {} failed health check(s), {} broken connection(s) dropped",
+                    connects, reuses, healthCheckFailures, brokenDiscarded);
+    }
+
+    // Disconnect every idle connection
+    void closeAll() {
+        std::vector<std::unique_ptr<PooledConnection>> all;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            for (auto& entry : idle) {
+                for (auto& pooled : entry.second) all.push_back(std::move(pooled));
+            }
+            idle.clear();
+        }
+        for (auto& pooled : all) disconnect(pooled);
+    }
+};
+
+inline void MQConnectionLease::release() {
+    if (entry && pool) pool->giveBack(std::move(entry));
+    entry.reset();
+}
+
+#endif // MQ_CONNECTION_POOL_H
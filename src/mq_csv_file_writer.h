@@ -0,0 +1,290 @@
+#ifndef MQ_CSV_FILE_WRITER_H
+#define MQ_CSV_FILE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/uio.h>
+#endif
+#include "mq_log.h"
+
+/**
+ * CSV File Writer - One thread writing every CSV report
+ *
+ * Workers format their rows into their own buffers and hand each full
+ * buffer over with submit(), which only queues it; no worker ever waits for
+ * the disk or for another worker's rows. The writer thread keeps each CSV
+ * file open across queue managers (closing it once it has been idle for a
+ * while, e.g. after a daemon rolled to a new file), writes the header when
+ * it opens an empty file, and writes whatever has queued up for a file with
+ * as few writev() calls as possible. Written buffers are recycled through
+ * takeBuffer(), so steady-state polls allocate no CSV memory.
+ */
+class CSVFileWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+private:
+    struct Chunk {
+        std::string path;
+        std::string data;
+    };
+
+    struct OpenFile {
+        int fd = -1;
+        std::chrono::steady_clock::time_point lastWrite;
+    };
+
+    static constexpr size_t MAX_IOV = 64;
+    static constexpr size_t MAX_SPARE_BUFFERS = 32;
+    static constexpr size_t BACKLOG_WARNING = 64 * 1024 * 1024;
+
+    MQLog& logger;
+    std::string header;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::condition_variable idle;
+    std::deque<Chunk> queue;
+    std::vector<std::string> spare;
+    size_t queuedBytes = 0;
+    bool writing = false;
+    bool closed = false;
+    bool backlogWarned = false;
+    std::thread writerThread;
+
+    // Writer thread state
+    std::map<std::string, OpenFile> files;
+    std::map<std::string, bool> failedPaths;
+    size_t bytesWritten = 0;
+    size_t writeCalls = 0;
+    size_t droppedBytes = 0;
+
+    static int openAppend(const std::string& path) {
+#ifdef _WIN32
+        return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        return ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+    }
+
+    static void closeFile(int fd) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    // Write every piece in full; false on an I/O error
+    bool writeAll(int fd, std::vector<const std::string*>& pieces) {
+#ifdef _WIN32
+        for (const std::string* piece : pieces) {
+            size_t done = 0;
+            while (done < piece->size()) {
+                int n = _write(fd, piece->data() + done, (unsigned int)(piece->size() - done));
+                if (n <= 0) return false;
+                done += (size_t)n;
+                writeCalls++;
+            }
+        }
+        return true;
+#else
+        size_t first = 0;
+        size_t offset = 0;      // Bytes of pieces[first] already written
+        while (first < pieces.size()) {
+            struct iovec iov[MAX_IOV];
+            int count = 0;
+            for (size_t i = first; i < pieces.size() && count < (int)MAX_IOV; i++, count++) {
+                size_t skip = (i == first) ? offset : 0;
+                iov[count].iov_base = (void*)(pieces[i]->data() + skip);
+                iov[count].iov_len = pieces[i]->size() - skip;
+            }
+            ssize_t n = ::writev(fd, iov, count);
+            if (n < 0) return false;
+            writeCalls++;
+            size_t left = (size_t)n;
+            while (first < pieces.size() && left >= pieces[first]->size() - offset) {
+                left -= pieces[first]->size() - offset;
+                offset = 0;
+                first++;
+            }
+            offset += left;
+        }
+        return true;
+#endif
+    }
+
+    // The open descriptor for path, opening (and writing the header to) an empty file; -1 on error
+    int fileFor(const std::string& path) {
+        auto it = files.find(path);
+        if (it != files.end()) return it->second.fd;
+        if (failedPaths.count(path)) return -1;
+
+        try {
+            std::filesystem::path dir = std::filesystem::path(path).parent_path();
+            if (!dir.empty() && !std::filesystem::exists(dir)) std::filesystem::create_directories(dir);
+        } catch (const std::exception&) {
+            // open() below reports the problem
+        }
+
+        int fd = openAppend(path);
+        if (fd < 0) {
+            logger.error("Could not open CSV file: {}", path);
+            failedPaths[path] = true;
+            return -1;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size == 0 && !header.empty()) {
+            std::vector<const std::string*> pieces{&header};
+            writeAll(fd, pieces);
+        }
+        files[path].fd = fd;
+        return fd;
+    }
+
+    void closeIdleFiles(std::chrono::steady_clock::time_point now) {
+        const auto idleLimit = std::chrono::minutes(5);
+        for (auto it = files.begin(); it != files.end();) {
+            if (now - it->second.lastWrite > idleLimit) {
+                closeFile(it->second.fd);
+                it = files.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void writeBatch(std::deque<Chunk>& batch) {
+        // Group by file, keeping the order of each file's chunks
+        std::map<std::string, std::vector<const std::string*>> byPath;
+        for (const Chunk& chunk : batch) byPath[chunk.path].push_back(&chunk.data);
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto& entry : byPath) {
+            size_t bytes = 0;
+            for (const std::string* piece : entry.second) bytes += piece->size();
+
+            int fd = fileFor(entry.first);
+            if (fd < 0) {
+                droppedBytes += bytes;
+                continue;
+            }
+            if (!writeAll(fd, entry.second)) {
+                logger.error("Write to CSV file {} failed", entry.first);
+                droppedBytes += bytes;
+                closeFile(fd);
+                files.erase(entry.first);
+                continue;
+            }
+            files[entry.first].lastWrite = now;
+            bytesWritten += bytes;
+        }
+        closeIdleFiles(now);
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this] { return closed || !queue.empty(); });
+            if (queue.empty() && closed) break;
+
+            std::deque<Chunk> batch;
+            batch.swap(queue);
+            queuedBytes = 0;
+            writing = true;
+            lock.unlock();
+
+            writeBatch(batch);
+
+            lock.lock();
+            for (Chunk& chunk : batch) {
+                if (spare.size() >= MAX_SPARE_BUFFERS) break;
+                chunk.data.clear();
+                spare.push_back(std::move(chunk.data));
+            }
+            writing = false;
+            idle.notify_all();
+        }
+
+        for (auto& entry : files) closeFile(entry.second.fd);
+        files.clear();
+    }
+
+public:
+    explicit CSVFileWriter(MQLog& log, const std::string& headerLine = "")
+        : logger(log), header(headerLine) {
+        writerThread = std::thread([this] { writerLoop(); });
+    }
+
+    ~CSVFileWriter() { close(); }
+
+    CSVFileWriter(const CSVFileWriter&) = delete;
+    CSVFileWriter& operator=(const CSVFileWriter&) = delete;
+
+    // An empty buffer with BUFFER_SIZE capacity, reused from written chunks when possible
+    std::string takeBuffer() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!spare.empty()) {
+                std::string buffer = std::move(spare.back());
+                spare.pop_back();
+                return buffer;
+            }
+        }
+        std::string buffer;
+        buffer.reserve(BUFFER_SIZE);
+        return buffer;
+    }
+
+    // Queue data for appending to path; returns at once
+    void submit(const std::string& path, std::string&& data) {
+        if (data.empty()) return;
+        std::lock_guard<std::mutex> guard(mutex);
+        queuedBytes += data.size();
+        if (queuedBytes > BACKLOG_WARNING && !backlogWarned) {
+            backlogWarned = true;
+            logger.warning("CSV writer is {} MiB behind; the disk is slower than the polls",
+                           queuedBytes / (1024 * 1024));
+        }
+        queue.push_back({path, std::move(data)});
+        changed.notify_one();
+    }
+
+    // Wait until everything submitted so far is written
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return (queue.empty() && !writing) || closed; });
+    }
+
+    // Write what is queued, close the files and stop the writer thread
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (closed) return;
+            closed = true;
+            changed.notify_all();
+        }
+        if (writerThread.joinable()) writerThread.join();
+        if (droppedBytes > 0) {
+            logger.info("CSV writer: {} KiB in {} write call(s), {} KiB lost to errors",
+                        bytesWritten / 1024, writeCalls, droppedBytes / 1024);
+        } else if (bytesWritten > 0) {
+            logger.info("CSV writer: {} KiB in {} write call(s)", bytesWritten / 1024, writeCalls);
+        }
+    }
+};
+
+#endif // MQ_CSV_FILE_WRITER_H
@@ -0,0 +1,216 @@
+#ifndef MQ_JOB_SCHEDULER_H
+#define MQ_JOB_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <algorithm>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include "mq_log.h"
+#include "mq_thread_pool.h"
+
+/**
+ * Poll Duration History - How long each queue manager's last run took
+ *
+ * Kept in a small text file ("QMNAME milliseconds" per line) so the next run
+ * can order its jobs. Queue managers without a recorded run are expected to
+ * take the average of the known ones.
+ */
+class PollDurationHistory {
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, long long> lastMs;
+
+public:
+    // Missing or unreadable files just mean there is no history yet
+    void load(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::lock_guard<std::mutex> guard(mutex);
+        while (getline(in, line)) {
+            std::istringstream fields(line);
+            std::string name;
+            long long ms = 0;
+            if (fields >> name >> ms && ms >= 0) lastMs[name] = ms;
+        }
+    }
+
+    bool save(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out.is_open()) return false;
+        std::lock_guard<std::mutex> guard(mutex);
+        for (const auto& entry : lastMs) out << entry.first << " " << entry.second << "\n";
+        return out.good();
+    }
+
+    void record(const std::string& name, long long ms) {
+        std::lock_guard<std::mutex> guard(mutex);
+        lastMs[name] = ms;
+    }
+
+    long long expectedMs(const std::string& name) {
+        std::lock_guard<std::mutex> guard(mutex);
+        auto it = lastMs.find(name);
+        if (it != lastMs.end()) return it->second;
+        if (lastMs.empty()) return 0;
+        long long total = 0;
+        for (const auto& entry : lastMs) total += entry.second;
+        return total / (long long)lastMs.size();
+    }
+};
+
+/**
+ * Job Scheduler - One job per queue manager, longest first, capped per host
+ *
+ * Jobs are started in order of expected duration (the last run's, from
+ * PollDurationHistory), so the long queue managers do not end up alone at
+ * the tail of a run while the other workers sit idle. At most perHostLimit
+ * jobs of the same host run at once, so a big host with many queue managers
+ * is not flooded; a worker whose next job is held back by that limit takes
+ * the longest job of another host instead. When no pending job can start,
+ * the worker goes back to the pool rather than wait, and the next job to
+ * end posts a worker again.
+ *
+ * A job is handed a done(polled) function and is over when it calls it,
+ * from any thread; a job that leaves its poll to the async engine keeps its
+ * host slot until the replies are in. Only a job that polled records its
+ * duration, so a queue manager that was skipped or could not be reached
+ * keeps the duration of its last real poll.
+ */
+class MQJobScheduler {
+public:
+    using Done = std::function<void(bool polled)>;
+    using Job = std::function<void(Done)>;
+
+private:
+    struct Entry {
+        std::string name;
+        std::string host;
+        long long expectedMs;
+        Job run;
+    };
+
+    MQLog& logger;
+    PollDurationHistory& history;
+    size_t perHostLimit;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Entry> pending;                         // Longest expected first once run() starts
+    std::unordered_map<std::string, size_t> running;    // Jobs in progress per host
+    size_t inProgress = 0;
+    size_t heldByHostLimit = 0;                         // Times a worker left jobs pending for a host slot
+    ThreadPool* workerPool = nullptr;                   // Set by run()
+    size_t workerLimit = 1;
+    size_t activeWorkers = 0;                           // Workers posted to the pool and not yet returned
+
+    // Index of the first pending job whose host has a free slot; caller holds the mutex
+    size_t nextRunnable() const {
+        for (size_t i = 0; i < pending.size(); i++) {
+            auto it = running.find(pending[i].host);
+            if (it == running.end() || it->second < perHostLimit) return i;
+        }
+        return pending.size();
+    }
+
+    // Post another worker if a pending job can start and the pool has room; caller holds the mutex
+    void startWorker() {
+        if (activeWorkers >= workerLimit || nextRunnable() == pending.size()) return;
+        activeWorkers++;
+        workerPool->post([this] { work(); });
+    }
+
+    void finish(const std::string& name, const std::string& host,
+                std::chrono::steady_clock::time_point started, bool polled) {
+        if (polled) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - started).count();
+            history.record(name, elapsed);
+        }
+        std::lock_guard<std::mutex> guard(mutex);
+        running[host]--;
+        inProgress--;
+        startWorker();      // The freed slot may let a held job start
+        changed.notify_all();
+    }
+
+    // Worker body: take runnable jobs until none can start
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            size_t index = nextRunnable();
+            if (index == pending.size()) {
+                // The rest wait for a host slot; finish() posts a worker when one frees up.
+                // Returning keeps this pool thread free for other tasks, e.g. async reports
+                if (!pending.empty()) heldByHostLimit++;
+                activeWorkers--;
+                changed.notify_all();
+                return;
+            }
+
+            Entry entry = std::move(pending[index]);
+            pending.erase(pending.begin() + index);
+            running[entry.host]++;
+            inProgress++;
+            lock.unlock();
+
+            auto started = std::chrono::steady_clock::now();
+            std::string name = entry.name;
+            std::string host = entry.host;
+            auto finished = std::make_shared<std::atomic<bool>>(false);
+            Done done = [this, name, host, started, finished](bool polled) {
+                if (!finished->exchange(true)) finish(name, host, started, polled);
+            };
+            // A job that throws is over too, or run() would wait for it forever
+            try {
+                entry.run(done);
+            } catch (const std::exception& e) {
+                logger.error("Job for {} failed: {}", name, e.what());
+                done(false);
+            }
+
+            lock.lock();
+        }
+    }
+
+public:
+    MQJobScheduler(MQLog& log, PollDurationHistory& durations, size_t maxPerHost)
+        : logger(log), history(durations), perHostLimit(maxPerHost > 0 ? maxPerHost : 1) {}
+
+    void add(const std::string& name, const std::string& host, Job job) {
+        std::lock_guard<std::mutex> guard(mutex);
+        pending.push_back({name, host, history.expectedMs(name), std::move(job)});
+    }
+
+    /**
+     * Run every added job on up to `workers` threads of the pool and wait
+     * until each has called done(). Call from outside the pool.
+     */
+    void run(ThreadPool& pool, size_t workers) {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::stable_sort(pending.begin(), pending.end(), [](const Entry& a, const Entry& b) {
+            return a.expectedMs > b.expectedMs;
+        });
+        if (!pending.empty()) {
+            logger.info("Scheduling {} job(s), longest first ({}, expected {} ms), at most {} per host",
+                        pending.size(), pending.front().name, pending.front().expectedMs, perHostLimit);
+        }
+
+        workerPool = &pool;
+        workerLimit = std::max<size_t>(1, workers);
+        for (size_t i = 0; i < std::min(workerLimit, pending.size()); i++) startWorker();
+
+        changed.wait(lock, [this] { return pending.empty() && inProgress == 0 && activeWorkers == 0; });
+        if (heldByHostLimit > 0) {
+            logger.info("Per-host limit held workers back {} time(s)", heldByHostLimit);
+        }
+    }
+};
+
+#endif // MQ_JOB_SCHEDULER_H
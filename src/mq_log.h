@@ -2,40 +2,479 @@
 #define MQ_LOG_H
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <iostream>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include "mq_log_format.h"
+#include "mq_log_limiter.h"
 
+// Levels below this are compiled out (0 trace, 1 debug, 2 info, 3 warning, 4 error)
+#ifndef MQ_LOG_COMPILE_LEVEL
+#define MQ_LOG_COMPILE_LEVEL 0
+#endif
+
+// What MQLog does with a line when its queue is full
+enum class LogOverflow {
+    Block,      // Wait for the writer thread to make room (nothing is lost)
+    Drop,       // Discard the line
+    Count       // Discard the line and log how many were discarded
+};
+
+// What MQLog writes to its file
+enum class LogFileFormat {
+    Text,       // Formatted lines
+    Binary      // Formats and values (see BinaryLog); read with --decode-log
+};
+
+/**
+ * Asynchronous logger
+ *
+ * log() and friends only put the line and the current time into a bounded
+ * lock-free ring buffer (many producers, one consumer) and return. A writer
+ * thread takes whatever has queued up, adds the "[YYYY-MM-DD HH:MM:SS] "
+ * prefix (formatted once per second, not per line) and writes the batch to
+ * stdout and the log file with one write and one flush each. It also rotates
+ * the file before it grows past maxFileSize, keeping maxBackups old files as
+ * path.1 (newest) to path.N, so producers never wait for the disk.
+ *
+ * A full queue is handled by the overflow policy; with Block, producers
+ * wait only while the writer catches up.
+ *
+ * Lines below the runtime level (setLevel()) are discarded before any text
+ * is built; below MQ_LOG_COMPILE_LEVEL they are not compiled at all. The
+ * template overloads take a format with "{}" placeholders and the values,
+ * which are only formatted when the line is enabled:
+ *
+ *     logger.debug("Parsed {} replies in {} us", records, micros);
+ *
+ * In binary mode (LogFileFormat::Binary) producers do not format at all:
+ * they copy the format's address and the values into the queue, and the
+ * writer thread writes them to the file as BinaryLog records and as text
+ * to stdout.
+ *
+ * errorFor() and warningFor() are for failures that repeat per queue
+ * manager during an outage; they go through a LogStormLimiter, and the
+ * writer thread logs its summaries of what was held back.
+ */
 class MQLog {
 private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        time_t when = 0;
+        bool multiLine = false;
+        unsigned thread = 0;
+        std::string text;       // Binary mode: BinaryLog entries
+    };
+
+    // An entry taken from the queue in binary mode, before its bytes
+    struct PendingEntry {
+        int64_t when;
+        uint32_t thread;
+        uint32_t length;
+    };
+
+    static constexpr size_t MAX_BATCH = 256 * 1024;
+
+    // Ring buffer: a slot is free for position pos when its sequence is pos,
+    // and holds the line of position pos when its sequence is pos + 1
+    std::vector<Slot> slots;
+    size_t mask;
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0;                      // Writer thread only
+
+    LogOverflow overflow;
+    std::atomic<size_t> droppedLines{0};
+    std::atomic<size_t> droppedUnreported{0};   // Count policy: not yet logged
+
+    // Sleeping writer, producers blocked on a full queue, callers of flush()
+    std::mutex waitMutex;
+    std::condition_variable writerWake;
+    std::condition_variable spaceFreed;
+    std::condition_variable flushed;
+    std::atomic<bool> writerSleeping{false};
+    std::atomic<int> blockedProducers{0};
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> writtenPos{0};          // Positions below this are written
+    std::atomic<int> minLevel{(int)LogLevel::Info};
+    const bool binary;
+
+    // Writer thread state; fileMutex also serialises reopen()
+    std::mutex fileMutex;
     std::ofstream logFile;
     std::string logPath;
     long maxFileSize;
     int maxBackups;
     long currentSize;
-    std::mutex logMutex;
+    time_t prefixTime = -1;
+    std::string prefix;
+    std::string batch;
+    std::string pendingEntries;                 // Binary mode: PendingEntry and bytes, per entry
+    std::string fileData;
+    BinaryLogEncoder encoder;                   // Guarded by fileMutex
+    LogStormLimiter storms;
+    std::vector<LogStormLimiter::Summary> summaries;
+    std::thread writerThread;
+
+    const std::string& prefixFor(time_t when) {
+        if (when != prefixTime) {
+            prefixTime = when;
+            prefix = logLinePrefix(when);
+        }
+        return prefix;
+    }
+
+    // Small number of the calling thread, recorded in binary logs
+    static unsigned threadNumber() {
+        static std::atomic<unsigned> threads{0};
+        thread_local unsigned number = ++threads;
+        return number;
+    }
+
+    // Per-thread buffer for binary entries; queueing swaps it with a slot's emptied buffer
+    static std::string& entryBuffer() {
+        thread_local std::string entry;
+        entry.clear();
+        return entry;
+    }
+
+    bool tryPush(std::string& text, bool multiLine) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.when = time(0);
+                    slot.multiLine = multiLine;
+                    slot.thread = threadNumber();
+                    slot.text.swap(text);
+                    slot.sequence.store(pos + 1);     // seq_cst: see wakeWriter()
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;       // Full: the writer has not freed this slot yet
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void wakeWriter() {
+        // Publishing the line and this load, like the writer's store of
+        // writerSleeping and its check of the next slot, are seq_cst: either
+        // the writer sees the new line before sleeping or this sees it asleep
+        if (writerSleeping.load()) {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            writerWake.notify_one();
+        }
+    }
+
+    void enqueue(std::string&& text, bool multiLine = false) {
+        if (tryPush(text, multiLine)) {
+            wakeWriter();
+            return;
+        }
+        if (overflow != LogOverflow::Block) {
+            droppedLines++;
+            if (overflow == LogOverflow::Count) droppedUnreported++;
+            return;
+        }
+        blockedProducers++;
+        while (!tryPush(text, multiLine)) {
+            wakeWriter();
+            std::unique_lock<std::mutex> lock(waitMutex);
+            spaceFreed.wait_for(lock, std::chrono::milliseconds(1));
+        }
+        blockedProducers--;
+        wakeWriter();
+    }
+
+    void queueEntry(std::string_view entry, time_t when, unsigned thread) {
+        PendingEntry pending{(int64_t)when, (uint32_t)thread, (uint32_t)entry.size()};
+        pendingEntries.append((const char*)&pending, sizeof(pending));
+        pendingEntries.append(entry);
+    }
 
-    std::string getTimestamp() const {
+    // Append one queued entry to batch, prefixing every line
+    void format(const Slot& slot) {
+        const std::string& linePrefix = prefixFor(slot.when);
+        if (binary) {
+            BinaryLog::renderEntries(batch, linePrefix, slot.text);
+            queueEntry(slot.text, slot.when, slot.thread);
+            return;
+        }
+        if (!slot.multiLine) {
+            batch += linePrefix;
+            batch += slot.text;
+            batch += '\n';
+            return;
+        }
+        size_t start = 0;
+        while (start < slot.text.size()) {
+            size_t end = slot.text.find('\n', start);
+            if (end == std::string::npos) end = slot.text.size();
+            batch += linePrefix;
+            batch.append(slot.text, start, end - start);
+            batch += '\n';
+            start = end + 1;
+        }
+    }
+
+    // Move the current file to path.1, shifting older backups up and dropping the oldest
+    void rotate() {
+        logFile.close();
+        std::error_code ec;
+        if (maxBackups > 0) {
+            std::filesystem::remove(logPath + "." + std::to_string(maxBackups), ec);
+            for (int i = maxBackups - 1; i >= 1; i--) {
+                std::filesystem::rename(logPath + "." + std::to_string(i),
+                                        logPath + "." + std::to_string(i + 1), ec);
+            }
+            std::filesystem::rename(logPath, logPath + ".1", ec);
+        }
+        logFile.open(logPath, fileMode(std::ios::trunc));
+        currentSize = 0;
+        startFile();
+    }
+
+    std::ios::openmode fileMode(std::ios::openmode mode) const {
+        return binary ? mode | std::ios::binary : mode;
+    }
+
+    // A binary log file starts with its header, and its formats and strings are numbered anew
+    void startFile() {
+        if (!binary) return;
+        encoder.reset();
+        if (!logFile.is_open()) return;
+        BinaryLogFileHeader header = BinaryLog::fileHeader();
+        logFile.write((const char*)&header, sizeof(header));
+        logFile.flush();
+        currentSize += (long)sizeof(header);
+    }
+
+    void writeFile(const std::string& data) {
+        if (data.empty() || !logFile.is_open()) return;
+        logFile.write(data.data(), (std::streamsize)data.size());
+        logFile.flush();
+        currentSize += (long)data.size();
+    }
+
+    // Encode the batch's entries into chunks, rotating before a chunk would overfill the file
+    void writeEntries() {
+        const char* p = pendingEntries.data();
+        const char* end = p + pendingEntries.size();
+        while (p < end) {
+            PendingEntry pending;
+            memcpy(&pending, p, sizeof(pending));
+            p += sizeof(pending);
+            std::string_view entry(p, pending.length);
+            p += pending.length;
+
+            if (!encoder.encode(entry, (time_t)pending.when, pending.thread)) continue;
+            long used = currentSize + (long)fileData.size();
+            if (maxFileSize > 0 && used + (long)encoder.pendingBytes() > maxFileSize &&
+                (used > (long)sizeof(BinaryLogFileHeader) || encoder.hasChunk())) {
+                encoder.finish(fileData);
+                writeFile(fileData);
+                fileData.clear();
+                rotate();
+                encoder.encode(entry, (time_t)pending.when, pending.thread);
+            }
+            encoder.commit(fileData);
+        }
+        pendingEntries.clear();
+        encoder.finish(fileData);
+        writeFile(fileData);
+        fileData.clear();
+    }
+
+    void writeBatch() {
+        if (!batch.empty()) {
+            std::cout.write(batch.data(), (std::streamsize)batch.size());
+            std::cout.flush();
+        }
+
+        std::lock_guard<std::mutex> guard(fileMutex);
+        if (binary) {
+            writeEntries();
+            return;
+        }
+        if (batch.empty()) return;
+        if (maxFileSize > 0 && currentSize > 0 && currentSize + (long)batch.size() > maxFileSize) {
+            rotate();
+        }
+        writeFile(batch);
+    }
+
+    // A line from the writer thread itself, added to the batch being written
+    void writeNotice(LogLevel level, const std::string& notice) {
         time_t now = time(0);
-        struct tm timeinfo;
-#ifdef _WIN32
-        localtime_s(&timeinfo, &now);
-#else
-        localtime_r(&now, &timeinfo);
-#endif
-        std::ostringstream oss;
-        oss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
-        return oss.str();
+        if (binary) {
+            std::string entry;
+            BinaryLog::putText(entry, BINLOG_TEXT, (unsigned)level, notice);
+            queueEntry(entry, now, 0);
+        }
+        batch += prefixFor(now);
+        batch += logLevelTag(level);
+        batch += notice;
+        batch += '\n';
+    }
+
+    // Write every entry that is ready (up to MAX_BATCH bytes); false if there was none
+    bool drain() {
+        batch.clear();
+        size_t taken = 0;
+        while (batch.size() < MAX_BATCH) {
+            Slot& slot = slots[dequeuePos & mask];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+            format(slot);
+            slot.text.clear();
+            slot.sequence.store(dequeuePos + slots.size(), std::memory_order_release);
+            dequeuePos++;
+            taken++;
+        }
+        size_t dropped = droppedUnreported.exchange(0);
+        if (dropped > 0) {
+            writeNotice(LogLevel::Warning, "Log queue full, " + std::to_string(dropped) + " line(s) dropped");
+        }
+        summaries.clear();
+        if (storms.due() || stopping) storms.collect(summaries, stopping);
+        for (const LogStormLimiter::Summary& summary : summaries) {
+            std::string notice;
+            formatInto(notice, "Suppressed {} repeat(s) of \"{}\" (Reason: {}) across {} queue manager(s) in the last {} s",
+                       LogStormLimiter::grouped(summary.suppressed), summary.format, summary.reason,
+                       summary.subjects, summary.seconds);
+            writeNotice(summary.level, notice);
+        }
+        if (taken > 0 && blockedProducers.load() > 0) {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            spaceFreed.notify_all();
+        }
+        writeBatch();
+        if (taken > 0) {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            writtenPos = dequeuePos;
+            flushed.notify_all();
+        }
+        return taken > 0 || dropped > 0 || !summaries.empty();
+    }
+
+    void writerLoop() {
+        while (true) {
+            if (drain()) continue;
+            if (stopping) {
+                if (drain()) continue;
+                break;
+            }
+            std::unique_lock<std::mutex> lock(waitMutex);
+            writerSleeping = true;
+            const Slot& next = slots[dequeuePos & mask];
+            if (next.sequence.load() != dequeuePos + 1 && !stopping &&
+                droppedUnreported.load() == 0) {
+                writerWake.wait_for(lock, std::chrono::milliseconds(200));
+            }
+            writerSleeping = false;
+        }
+    }
+
+    static void appendValue(std::string& out, std::string_view value) { out.append(value); }
+    static void appendValue(std::string& out, const std::string& value) { out.append(value); }
+    static void appendValue(std::string& out, const char* value) { out.append(value ? value : "(null)"); }
+    static void appendValue(std::string& out, char value) { out += value; }
+    static void appendValue(std::string& out, bool value) { out.append(value ? "true" : "false"); }
+
+    // Floating point values are written as doubles, as the binary log stores them
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value>::type appendValue(std::string& out, T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            BinaryLog::appendNumber(out, (double)value);
+        } else {
+            BinaryLog::appendNumber(out, value);
+        }
+    }
+
+    static void formatInto(std::string& out, std::string_view format) {
+        out.append(format);
+    }
+
+    // Replace each placeholder of format (see LogFormat) with the next value
+    template <typename T, typename... Rest>
+    static void formatInto(std::string& out, std::string_view format, const T& value, const Rest&... rest) {
+        LogPlaceholder placeholder;
+        if (!LogFormat::find(format, placeholder)) {
+            out.append(format);
+            return;
+        }
+        out.append(format.substr(0, placeholder.at));
+        size_t start = out.size();
+        appendValue(out, value);
+        LogFormat::pad(out, start, placeholder);
+        formatInto(out, format.substr(placeholder.at + placeholder.length), rest...);
+    }
+
+    template <LogLevel L, typename... Args>
+    void write(const char* format, const Args&... args) {
+        if constexpr ((int)L >= MQ_LOG_COMPILE_LEVEL) {
+            if (!enabled<L>()) return;
+            if (binary) {
+                std::string& entry = entryBuffer();
+                BinaryLog::putLine(entry, (unsigned)L, format, args...);
+                enqueue(std::move(entry));
+                return;
+            }
+            std::string line = logLevelTag(L);
+            formatInto(line, format, args...);
+            enqueue(std::move(line));
+        }
+    }
+
+    template <LogLevel L, typename... Args>
+    void writeFor(std::string_view subject, long reason, const char* format, const Args&... args) {
+        if constexpr ((int)L >= MQ_LOG_COMPILE_LEVEL) {
+            if (!enabled<L>() || !storms.allow(L, format, reason, subject)) return;
+            write<L>(format, args...);
+        }
+    }
+
+    template <LogLevel L>
+    void write(const std::string& msg) {
+        if constexpr ((int)L >= MQ_LOG_COMPILE_LEVEL) {
+            if (!enabled<L>()) return;
+            if (binary) {
+                std::string& entry = entryBuffer();
+                BinaryLog::putText(entry, BINLOG_TEXT, (unsigned)L, msg);
+                enqueue(std::move(entry));
+                return;
+            }
+            enqueue(logLevelTag(L) + msg);
+        }
     }
 
 public:
-    MQLog(const std::string& path, int sizeMB = 10, int backups = 5)
-        : logPath(path), maxBackups(backups), currentSize(0) {
-        maxFileSize = sizeMB * 1024 * 1024;
+    MQLog(const std::string& path, int sizeMB = 10, int backups = 5, size_t queueSize = 8192,
+          LogOverflow overflowPolicy = LogOverflow::Block, LogFileFormat fileFormat = LogFileFormat::Text)
+        : overflow(overflowPolicy), binary(fileFormat == LogFileFormat::Binary), logPath(path),
+          maxBackups(backups), currentSize(0) {
+        maxFileSize = (long)sizeMB * 1024 * 1024;
+
+        size_t capacity = 2;
+        while (capacity < queueSize) capacity *= 2;
+        slots = std::vector<Slot>(capacity);
+        for (size_t i = 0; i < capacity; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+        mask = capacity - 1;
 
         // Create directory if it doesn't exist
         try {
@@ -48,44 +487,192 @@ public:
             std::cerr << "WARNING: Could not create log directory: " << e.what() << std::endl;
         }
 
-        logFile.open(path, std::ios::trunc);
+        logFile.open(path, fileMode(std::ios::trunc));
         if (!logFile.is_open()) {
             std::cerr << "WARNING: Could not open log file: " << path << std::endl;
         }
+        startFile();
+        writerThread = std::thread([this] { writerLoop(); });
     }
 
+    // Writes everything still queued
     ~MQLog() {
+        {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            stopping = true;
+            writerWake.notify_one();
+        }
+        if (writerThread.joinable()) writerThread.join();
+        if (droppedLines > 0) {
+            std::cerr << "WARNING: " << droppedLines << " log line(s) dropped because the log queue was full"
+                      << std::endl;
+        }
         if (logFile.is_open()) {
             logFile.close();
         }
     }
 
-    void info(const std::string& msg) {
-        log("[INFO] " + msg);
+    MQLog(const MQLog&) = delete;
+    MQLog& operator=(const MQLog&) = delete;
+
+    static bool parseLevel(const std::string& name, LogLevel& level) {
+        if (name == "trace") level = LogLevel::Trace;
+        else if (name == "debug") level = LogLevel::Debug;
+        else if (name == "info") level = LogLevel::Info;
+        else if (name == "warning" || name == "warn") level = LogLevel::Warning;
+        else if (name == "error") level = LogLevel::Error;
+        else return false;
+        return true;
+    }
+
+    void setLevel(LogLevel level) { minLevel = (int)level; }
+
+    // Whether a line of this level would be written; for callers that prepare costly detail
+    template <LogLevel L = LogLevel::Info>
+    bool enabled() const {
+        if constexpr ((int)L < MQ_LOG_COMPILE_LEVEL) return false;
+        else return (int)L >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    template <typename... Args>
+    void trace(const char* format, const Args&... args) { write<LogLevel::Trace>(format, args...); }
+    void trace(const std::string& msg) { write<LogLevel::Trace>(msg); }
+
+    template <typename... Args>
+    void debug(const char* format, const Args&... args) { write<LogLevel::Debug>(format, args...); }
+    void debug(const std::string& msg) { write<LogLevel::Debug>(msg); }
+
+    template <typename... Args>
+    void info(const char* format, const Args&... args) { write<LogLevel::Info>(format, args...); }
+    void info(const std::string& msg) { write<LogLevel::Info>(msg); }
+
+    template <typename... Args>
+    void warning(const char* format, const Args&... args) { write<LogLevel::Warning>(format, args...); }
+    void warning(const std::string& msg) { write<LogLevel::Warning>(msg); }
+
+    template <typename... Args>
+    void error(const char* format, const Args&... args) { write<LogLevel::Error>(format, args...); }
+    void error(const std::string& msg) { write<LogLevel::Error>(msg); }
+
+    /**
+     * A failure of one queue manager that repeats across the fleet during an
+     * outage, such as a refused connection. Lines with the same format and
+     * reason are rate limited (see LogStormLimiter); subject is the queue
+     * manager's name.
+     */
+    template <typename... Args>
+    void errorFor(std::string_view subject, long reason, const char* format, const Args&... args) {
+        writeFor<LogLevel::Error>(subject, reason, format, args...);
     }
 
-    void error(const std::string& msg) {
-        log("[ERROR] " + msg);
+    template <typename... Args>
+    void warningFor(std::string_view subject, long reason, const char* format, const Args&... args) {
+        writeFor<LogLevel::Warning>(subject, reason, format, args...);
     }
 
-    void warning(const std::string& msg) {
-        log("[WARNING] " + msg);
+    // At most maxLines lines per format and reason every intervalSeconds; 0 lines disables the limit
+    void setRepeatLimit(int maxLines, int intervalSeconds) {
+        storms.configure((size_t)std::max(0, maxLines), intervalSeconds);
     }
 
+    // A line without a level tag; logged at Info
     void log(const std::string& msg) {
-        std::lock_guard<std::mutex> guard(logMutex);
-        std::string output = "[" + getTimestamp() + "] " + msg;
-        std::cout << output << std::endl;
-        std::cout.flush();
+        if (!enabled<LogLevel::Info>()) return;
+        if (binary) {
+            std::string& entry = entryBuffer();
+            BinaryLog::putText(entry, BINLOG_TEXT, BINLOG_NO_LEVEL, msg);
+            enqueue(std::move(entry));
+            return;
+        }
+        enqueue(std::string(msg));
+    }
 
-        if (logFile.is_open()) {
-            logFile << output << std::endl;
-            logFile.flush();
-            currentSize += output.length() + 1;
+    /**
+     * Log several lines, each ending in '\n', as one entry: one timestamp,
+     * written together with no other thread's lines in between.
+     */
+    void logBlock(const std::string& lines) {
+        if (lines.empty() || !enabled<LogLevel::Info>()) return;
+        if (binary) {
+            std::string& entry = entryBuffer();
+            BinaryLog::putText(entry, BINLOG_LINES, BINLOG_NO_LEVEL, lines);
+            enqueue(std::move(entry));
+            return;
+        }
+        enqueue(std::string(lines), true);
+    }
+
+    bool binaryFormat() const { return binary; }
+
+    // Binary mode: add a line without a level tag to records, keeping its values unformatted
+    template <typename... Args>
+    static void appendRecord(std::string& records, const char* format, const Args&... args) {
+        BinaryLog::putLine(records, BINLOG_NO_LEVEL, format, args...);
+    }
+
+    // Binary mode: add lines, each ending in '\n', to records
+    static void appendLines(std::string& records, std::string_view lines) {
+        BinaryLog::putText(records, BINLOG_LINES, BINLOG_NO_LEVEL, lines);
+    }
+
+    // Binary mode: log records as one entry, like logBlock(); records is left empty
+    void logRecords(std::string& records) {
+        if (!records.empty() && enabled<LogLevel::Info>()) enqueue(std::move(records));
+        records.clear();
+    }
+
+    // Wait until every line logged before the call has been written
+    void flush() {
+        size_t target = enqueuePos.load();
+        std::unique_lock<std::mutex> lock(waitMutex);
+        writerWake.notify_one();
+        flushed.wait(lock, [this, target] { return writtenPos.load() >= target; });
+    }
+
+    // Lines lost to a full queue (Drop and Count policies)
+    size_t dropped() const { return droppedLines.load(); }
+
+    // Continue in a new file (time-based rolling); the old file is closed
+    bool reopen(const std::string& path) {
+        flush();
+        std::lock_guard<std::mutex> guard(fileMutex);
+        std::ofstream next(path, fileMode(std::ios::app));
+        if (!next.is_open()) {
+            std::cerr << "WARNING: Could not open log file: " << path << std::endl;
+            return false;
         }
+        if (logFile.is_open()) logFile.close();
+        logFile = std::move(next);
+        logPath = path;
+        // Restarting within a roll period appends to that period's file; rotation counts what it holds
+        std::error_code ec;
+        std::uintmax_t existing = std::filesystem::file_size(path, ec);
+        currentSize = ec ? 0 : (long)existing;
+        startFile();
+        return true;
+    }
+
+    std::string getPath() {
+        std::lock_guard<std::mutex> guard(fileMutex);
+        return logPath;
+    }
+
+    // "text" or "binary"; false for anything else
+    static bool parseFileFormat(const std::string& name, LogFileFormat& format) {
+        if (name == "text") format = LogFileFormat::Text;
+        else if (name == "binary") format = LogFileFormat::Binary;
+        else return false;
+        return true;
     }
 
-    std::string getPath() const { return logPath; }
+    // "block", "drop" or "count"; false for anything else
+    static bool parseOverflow(const std::string& name, LogOverflow& policy) {
+        if (name == "block") policy = LogOverflow::Block;
+        else if (name == "drop") policy = LogOverflow::Drop;
+        else if (name == "count") policy = LogOverflow::Count;
+        else return false;
+        return true;
+    }
 };
 
 #endif // MQ_LOG_H
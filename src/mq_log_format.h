@@ -0,0 +1,757 @@
+#ifndef MQ_LOG_FORMAT_H
+#define MQ_LOG_FORMAT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+#include "mq_string_interner.h"
+
+enum class LogLevel {
+    Trace = 0,      // Per-reply and per-message detail
+    Debug = 1,      // Per-poll timings and counters
+    Info = 2,
+    Warning = 3,
+    Error = 4
+};
+
+inline const char* logLevelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:   return "[TRACE] ";
+        case LogLevel::Debug:   return "[DEBUG] ";
+        case LogLevel::Info:    return "[INFO] ";
+        case LogLevel::Warning: return "[WARNING] ";
+        default:                return "[ERROR] ";
+    }
+}
+
+// "[YYYY-MM-DD HH:MM:SS] ", the start of every log line
+inline std::string logLinePrefix(time_t when) {
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &when);
+#else
+    localtime_r(&when, &timeinfo);
+#endif
+    std::ostringstream oss;
+    oss << "[" << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S") << "] ";
+    return oss.str();
+}
+
+// One placeholder of a log format: "{}", "{:N}" (padded to N) or "{:>N}" (right-aligned)
+struct LogPlaceholder {
+    size_t at = 0;
+    size_t length = 0;
+    size_t width = 0;
+    bool right = false;
+};
+
+/**
+ * Log Format - Placeholders of log formats
+ *
+ * A format is text with placeholders, each replaced by the next value.
+ * "{:N}" pads its value with spaces to N characters and "{:>N}" aligns it
+ * right; wider values are kept whole. A '{' that does not start a
+ * placeholder is plain text.
+ */
+class LogFormat {
+public:
+    // First placeholder of format; false if it has none
+    static bool find(std::string_view format, LogPlaceholder& placeholder) {
+        size_t at = format.find('{');
+        while (at != std::string_view::npos) {
+            size_t i = at + 1;
+            size_t width = 0;
+            bool right = false;
+            if (i < format.size() && format[i] == ':') {
+                i++;
+                if (i < format.size() && format[i] == '>') {
+                    right = true;
+                    i++;
+                }
+                while (i < format.size() && format[i] >= '0' && format[i] <= '9') {
+                    width = width * 10 + (format[i] - '0');
+                    i++;
+                }
+            }
+            if (i < format.size() && format[i] == '}') {
+                placeholder.at = at;
+                placeholder.length = i + 1 - at;
+                placeholder.width = width;
+                placeholder.right = right;
+                return true;
+            }
+            at = format.find('{', at + 1);
+        }
+        return false;
+    }
+
+    // Pad the value appended to out since start to the placeholder's width
+    static void pad(std::string& out, size_t start, const LogPlaceholder& placeholder) {
+        size_t length = out.size() - start;
+        if (length >= placeholder.width) return;
+        if (placeholder.right) {
+            out.insert(start, placeholder.width - length, ' ');
+        } else {
+            out.append(placeholder.width - length, ' ');
+        }
+    }
+};
+
+/**
+ * Binary Log - Compact log file of MQLog's binary mode (log_format = "binary")
+ *
+ * Lines keep their format and values instead of being formatted. A file is
+ * a BinaryLogFileHeader followed by chunks: a BinaryLogChunkHeader and up
+ * to about BINLOG_CHUNK_SIZE bytes of whole records. Records start with a
+ * byte holding their kind (high nibble) and level (low nibble):
+ *
+ *   FORMAT  id, text           the text of a format, before its first use
+ *   LINE    thread, time, format id, value count, values
+ *   TEXT    thread, time, text       a line logged without a format
+ *   LINES   thread, time, text       several lines ('\n' ended) as one entry
+ *
+ * Numbers are LEB128 varints; signed ones are zigzag-encoded and times are
+ * seconds since the previous record. A value is a BinaryLogTag and its
+ * payload. A string of 1 to BINLOG_MAX_INTERNED bytes is written the first
+ * time the file uses it and is then referred to by number (the count of
+ * such strings before it, from 1), so repeated queue, channel and user names
+ * cost a byte or two. Format and string numbers start over at each file
+ * header; a file that was appended to has one for every writer.
+ */
+enum BinaryLogKind : uint8_t {
+    BINLOG_FORMAT = 1,
+    BINLOG_LINE = 2,
+    BINLOG_TEXT = 3,
+    BINLOG_LINES = 4
+};
+
+enum BinaryLogTag : uint8_t {
+    BINLOG_STRING = 1,          // varint length, bytes
+    BINLOG_STRING_REF = 2,      // varint number of an earlier string
+    BINLOG_INT = 3,             // zigzag varint
+    BINLOG_UINT = 4,            // varint
+    BINLOG_DOUBLE = 5,          // 8 bytes
+    BINLOG_CHAR = 6,            // 1 byte
+    BINLOG_FALSE = 7,
+    BINLOG_TRUE = 8
+};
+
+static constexpr unsigned BINLOG_NO_LEVEL = 15;             // Lines without a level tag
+static constexpr size_t BINLOG_CHUNK_SIZE = 64 * 1024;
+static constexpr size_t BINLOG_MAX_INTERNED = 64;           // Longest string written once per file
+static constexpr size_t BINLOG_MAX_STRINGS = 65536;         // Strings numbered per file
+
+#pragma pack(push, 1)
+struct BinaryLogFileHeader {
+    char magic[8];              // "MQBLOG\0\1"
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct BinaryLogChunkHeader {
+    char magic[4];              // "MQLC"
+    uint32_t length;            // Bytes of records that follow
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryLogFileHeader) == 16, "binary log file header layout");
+static_assert(sizeof(BinaryLogChunkHeader) == 8, "binary log chunk header layout");
+
+/**
+ * Encoding shared by MQLog's producers, its writer thread and the decoder.
+ *
+ * Producers queue entries, not records: a LINE entry holds the address of
+ * its format instead of a number and every string inline, so queueing a
+ * line only copies its values. BinaryLogEncoder turns entries into records.
+ */
+class BinaryLog {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    static char* writeVarint(char* p, uint64_t value) {
+        while (value >= 0x80) {
+            *p++ = (char)(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = (char)value;
+        return p;
+    }
+
+    static void putVarint(std::string& out, uint64_t value) {
+        char bytes[10];
+        out.append(bytes, writeVarint(bytes, value) - bytes);
+    }
+
+    static bool getVarint(const char*& p, const char* end, uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t byte = (uint8_t)*p++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static uint64_t zigzag(int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+    static int64_t unzigzag(uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+    // Most bytes writeValue() writes for a value: tag, varint and payload
+    static size_t valueBound(std::string_view value) { return 11 + value.size(); }
+    static size_t valueBound(const std::string& value) { return 11 + value.size(); }
+    static size_t valueBound(const char* value) { return 11 + (value ? strlen(value) : 6); }
+    static size_t valueBound(char) { return 2; }
+    static size_t valueBound(bool) { return 1; }
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value, size_t>::type valueBound(T) { return 11; }
+
+    static char* writeValue(char* p, std::string_view value) {
+        *p++ = (char)BINLOG_STRING;
+        p = writeVarint(p, value.size());
+        memcpy(p, value.data(), value.size());
+        return p + value.size();
+    }
+    static char* writeValue(char* p, const std::string& value) { return writeValue(p, std::string_view(value)); }
+    static char* writeValue(char* p, const char* value) {
+        return writeValue(p, std::string_view(value ? value : "(null)"));
+    }
+    static char* writeValue(char* p, char value) {
+        *p++ = (char)BINLOG_CHAR;
+        *p++ = value;
+        return p;
+    }
+    static char* writeValue(char* p, bool value) {
+        *p++ = (char)(value ? BINLOG_TRUE : BINLOG_FALSE);
+        return p;
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value, char*>::type writeValue(char* p, T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            double number = value;
+            *p++ = (char)BINLOG_DOUBLE;
+            memcpy(p, &number, sizeof(number));
+            return p + sizeof(number);
+        } else if constexpr (std::is_signed<T>::value) {
+            *p++ = (char)BINLOG_INT;
+            return writeVarint(p, zigzag(value));
+        } else {
+            *p++ = (char)BINLOG_UINT;
+            return writeVarint(p, value);
+        }
+    }
+
+    /**
+     * A LINE entry: level, the address of format (a string literal) and the
+     * values. Room for the longest encoding is made once, then the values
+     * are copied in through a pointer.
+     */
+    template <typename... Args>
+    static void putLine(std::string& out, unsigned level, const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) < 256, "too many values for one log line");
+        size_t used = out.size();
+        out.resize(used + 2 + sizeof(format) + (valueBound(args) + ... + 0));
+        char* p = &out[used];
+        *p++ = (char)(BINLOG_LINE << 4 | level);
+        memcpy(p, &format, sizeof(format));
+        p += sizeof(format);
+        *p++ = (char)sizeof...(Args);
+        ((p = writeValue(p, args)), ...);
+        out.resize(p - out.data());
+    }
+
+    // A TEXT entry, or a LINES entry of lines that each end in '\n'
+    static void putText(std::string& out, BinaryLogKind kind, unsigned level, std::string_view text) {
+        out += (char)(kind << 4 | level);
+        putVarint(out, text.size());
+        out.append(text);
+    }
+
+    template <typename T>
+    static void appendNumber(std::string& out, T value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr - digits);
+    }
+
+    /**
+     * Append the text of the value at p and step past it. With strings, the
+     * numbered strings of the file are resolved and extended as the encoder
+     * extended them; entries have no references and pass nullptr.
+     */
+    static bool appendValue(std::string& out, const char*& p, const char* end,
+                            std::vector<std::string>* strings) {
+        if (p >= end) return false;
+        uint8_t tag = (uint8_t)*p++;
+        uint64_t number;
+        switch (tag) {
+            case BINLOG_STRING:
+                if (!getVarint(p, end, number) || number > (uint64_t)(end - p)) return false;
+                if (strings && number >= 1 && number <= BINLOG_MAX_INTERNED &&
+                    strings->size() < BINLOG_MAX_STRINGS) {
+                    strings->emplace_back(p, number);
+                }
+                out.append(p, number);
+                p += number;
+                return true;
+            case BINLOG_STRING_REF:
+                if (!getVarint(p, end, number) || !strings || number >= strings->size()) return false;
+                out.append((*strings)[number]);
+                return true;
+            case BINLOG_INT:
+                if (!getVarint(p, end, number)) return false;
+                appendNumber(out, (long long)unzigzag(number));
+                return true;
+            case BINLOG_UINT:
+                if (!getVarint(p, end, number)) return false;
+                appendNumber(out, (unsigned long long)number);
+                return true;
+            case BINLOG_DOUBLE: {
+                if (end - p < (ptrdiff_t)sizeof(double)) return false;
+                double value;
+                memcpy(&value, p, sizeof(value));
+                p += sizeof(value);
+                appendNumber(out, value);
+                return true;
+            }
+            case BINLOG_CHAR:
+                if (p >= end) return false;
+                out += *p++;
+                return true;
+            case BINLOG_FALSE:
+                out.append("false");
+                return true;
+            case BINLOG_TRUE:
+                out.append("true");
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Append format with its placeholders replaced by the count values at p
+    static bool render(std::string& out, std::string_view format, unsigned count,
+                       const char*& p, const char* end, std::vector<std::string>* strings) {
+        std::string unused;
+        for (unsigned i = 0; i < count; i++) {
+            LogPlaceholder placeholder;
+            if (!LogFormat::find(format, placeholder)) {
+                unused.clear();
+                if (!appendValue(unused, p, end, strings)) return false;
+                continue;
+            }
+            out.append(format.substr(0, placeholder.at));
+            size_t start = out.size();
+            if (!appendValue(out, p, end, strings)) return false;
+            LogFormat::pad(out, start, placeholder);
+            format.remove_prefix(placeholder.at + placeholder.length);
+        }
+        out.append(format);
+        return true;
+    }
+
+    static void startLine(std::string& out, const std::string& prefix, unsigned level) {
+        out += prefix;
+        if (level != BINLOG_NO_LEVEL) out += logLevelTag((LogLevel)level);
+    }
+
+    // The text of a TEXT or LINES record or entry, each line prefixed
+    static void appendText(std::string& out, const std::string& prefix, unsigned kind, unsigned level,
+                           std::string_view text) {
+        if (kind != BINLOG_LINES) {
+            startLine(out, prefix, level);
+            out.append(text);
+            out += '\n';
+            return;
+        }
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string_view::npos) end = text.size();
+            startLine(out, prefix, level);
+            out.append(text, start, end - start);
+            out += '\n';
+            start = end + 1;
+        }
+    }
+
+    // Text of queued entries, as MQLog writes it in text mode
+    static bool renderEntries(std::string& out, const std::string& prefix, std::string_view entries) {
+        const char* p = entries.data();
+        const char* end = p + entries.size();
+        while (p < end) {
+            uint8_t head = (uint8_t)*p++;
+            unsigned kind = head >> 4;
+            unsigned level = head & 15;
+            if (kind == BINLOG_LINE) {
+                if (end - p < (ptrdiff_t)sizeof(const char*) + 1) return false;
+                const char* format;
+                memcpy(&format, p, sizeof(format));
+                p += sizeof(format);
+                unsigned count = (uint8_t)*p++;
+                startLine(out, prefix, level);
+                if (!render(out, format, count, p, end, nullptr)) return false;
+                out += '\n';
+            } else if (kind == BINLOG_TEXT || kind == BINLOG_LINES) {
+                uint64_t length;
+                if (!getVarint(p, end, length) || length > (uint64_t)(end - p)) return false;
+                appendText(out, prefix, kind, level, std::string_view(p, length));
+                p += length;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static BinaryLogFileHeader fileHeader() {
+        BinaryLogFileHeader header = {};
+        memcpy(header.magic, "MQBLOG\0\1", sizeof(header.magic));
+        header.version = VERSION;
+        return header;
+    }
+};
+
+/**
+ * Turns queued entries into the records of one file. The writer thread
+ * encodes an entry, commits it to the chunk being filled and finishes the
+ * chunk when it writes; reset() starts the numbering over for a new file.
+ */
+class BinaryLogEncoder {
+private:
+    std::unordered_map<const char*, uint32_t> formatIds;
+    StringInterner strings;         // Numbered strings of the file; 0 is unused ("")
+    time_t lastTime = 0;
+    std::string records;            // Of the last encode()
+    std::string chunk;              // Committed records not yet in a chunk
+
+    // Defined by the last encode(); numbered only once its records are committed
+    std::vector<const char*> newFormats;
+    std::vector<std::string> newStrings;
+    time_t encodedTime = 0;
+
+    bool findFormat(const char* format, uint32_t& id) const {
+        auto it = formatIds.find(format);
+        if (it != formatIds.end()) {
+            id = it->second;
+            return true;
+        }
+        for (size_t i = 0; i < newFormats.size(); i++) {
+            if (newFormats[i] == format) {
+                id = (uint32_t)(formatIds.size() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool findString(std::string_view value, uint32_t& id) const {
+        if (strings.find(value, id)) return true;
+        for (size_t i = 0; i < newStrings.size(); i++) {
+            if (newStrings[i] == value) {
+                id = (uint32_t)(strings.size() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool copyValue(const char*& p, const char* end) {
+        if (p >= end) return false;
+        const char* start = p;
+        uint8_t tag = (uint8_t)*p++;
+        uint64_t number;
+        switch (tag) {
+            case BINLOG_STRING: {
+                if (!BinaryLog::getVarint(p, end, number) || number > (uint64_t)(end - p)) return false;
+                std::string_view value(p, number);
+                p += number;
+                if (number >= 1 && number <= BINLOG_MAX_INTERNED) {
+                    uint32_t id;
+                    if (findString(value, id)) {
+                        records += (char)BINLOG_STRING_REF;
+                        BinaryLog::putVarint(records, id);
+                        return true;
+                    }
+                    if (strings.size() + newStrings.size() < BINLOG_MAX_STRINGS) {
+                        newStrings.emplace_back(value);
+                    }
+                }
+                records.append(start, p - start);
+                return true;
+            }
+            case BINLOG_INT:
+            case BINLOG_UINT:
+                if (!BinaryLog::getVarint(p, end, number)) return false;
+                break;
+            case BINLOG_DOUBLE:
+                if (end - p < (ptrdiff_t)sizeof(double)) return false;
+                p += sizeof(double);
+                break;
+            case BINLOG_CHAR:
+                if (p >= end) return false;
+                p++;
+                break;
+            case BINLOG_FALSE:
+            case BINLOG_TRUE:
+                break;
+            default:
+                return false;
+        }
+        records.append(start, p - start);
+        return true;
+    }
+
+    void putRecordStart(uint8_t head, unsigned thread, time_t when) {
+        records += (char)head;
+        BinaryLog::putVarint(records, thread);
+        BinaryLog::putVarint(records, BinaryLog::zigzag((int64_t)(when - encodedTime)));
+        encodedTime = when;
+    }
+
+public:
+    void reset() {
+        formatIds.clear();
+        strings.clear();
+        lastTime = 0;
+        records.clear();
+        chunk.clear();
+        newFormats.clear();
+        newStrings.clear();
+    }
+
+    /**
+     * Encode an entry queued at when by thread; false if it is malformed.
+     * The formats and strings it defines are numbered by commit(), so an
+     * entry that is dropped leaves the file's numbering as it was.
+     */
+    bool encode(std::string_view entry, time_t when, unsigned thread) {
+        records.clear();
+        newFormats.clear();
+        newStrings.clear();
+        encodedTime = lastTime;
+        const char* p = entry.data();
+        const char* end = p + entry.size();
+        while (p < end) {
+            uint8_t head = (uint8_t)*p++;
+            unsigned kind = head >> 4;
+            if (kind == BINLOG_LINE) {
+                if (end - p < (ptrdiff_t)sizeof(const char*) + 1) return false;
+                const char* format;
+                memcpy(&format, p, sizeof(format));
+                p += sizeof(format);
+                unsigned count = (uint8_t)*p++;
+
+                uint32_t id;
+                if (!findFormat(format, id)) {
+                    id = (uint32_t)(formatIds.size() + newFormats.size());
+                    newFormats.push_back(format);
+                    records += (char)(BINLOG_FORMAT << 4);
+                    BinaryLog::putVarint(records, id);
+                    size_t length = strlen(format);
+                    BinaryLog::putVarint(records, length);
+                    records.append(format, length);
+                }
+                putRecordStart(head, thread, when);
+                BinaryLog::putVarint(records, id);
+                records += (char)count;
+                for (unsigned i = 0; i < count; i++) {
+                    if (!copyValue(p, end)) return false;
+                }
+            } else if (kind == BINLOG_TEXT || kind == BINLOG_LINES) {
+                uint64_t length;
+                if (!BinaryLog::getVarint(p, end, length) || length > (uint64_t)(end - p)) return false;
+                putRecordStart(head, thread, when);
+                BinaryLog::putVarint(records, length);
+                records.append(p, length);
+                p += length;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Bytes the file grows by if the last encode() is committed and the chunk finished
+    size_t pendingBytes() const {
+        size_t total = chunk.size() + records.size() + sizeof(BinaryLogChunkHeader);
+        if (!chunk.empty() && chunk.size() + records.size() > BINLOG_CHUNK_SIZE) {
+            total += sizeof(BinaryLogChunkHeader);
+        }
+        return total;
+    }
+
+    bool hasChunk() const { return !chunk.empty(); }
+
+    // Add the last encode() to the chunk being filled, finishing a full chunk into out first
+    void commit(std::string& out) {
+        if (!chunk.empty() && chunk.size() + records.size() > BINLOG_CHUNK_SIZE) finish(out);
+        chunk.append(records);
+        records.clear();
+        for (const char* format : newFormats) formatIds.emplace(format, (uint32_t)formatIds.size());
+        for (const std::string& value : newStrings) strings.intern(value);
+        newFormats.clear();
+        newStrings.clear();
+        lastTime = encodedTime;
+    }
+
+    // Append the chunk being filled to out
+    void finish(std::string& out) {
+        if (chunk.empty()) return;
+        BinaryLogChunkHeader header;
+        memcpy(header.magic, "MQLC", sizeof(header.magic));
+        header.length = (uint32_t)chunk.size();
+        out.append((const char*)&header, sizeof(header));
+        out.append(chunk);
+        chunk.clear();
+    }
+};
+
+/**
+ * Reads a binary log and writes it as the text MQLog writes in text mode:
+ * the same timestamps, level tags, formats and padding.
+ */
+class BinaryLogDecoder {
+private:
+    std::vector<std::string> formats;
+    std::vector<std::string> strings;
+    time_t lastTime = 0;
+    time_t prefixTime = -1;
+    std::string prefix;
+    std::string errorText;
+
+    void reset() {
+        formats.clear();
+        strings.assign(1, std::string());
+        lastTime = 0;
+    }
+
+    const std::string& prefixFor(time_t when) {
+        if (when != prefixTime) {
+            prefixTime = when;
+            prefix = logLinePrefix(when);
+        }
+        return prefix;
+    }
+
+    bool decodeChunk(const char* p, const char* end, std::string& out) {
+        while (p < end) {
+            uint8_t head = (uint8_t)*p++;
+            unsigned kind = head >> 4;
+            unsigned level = head & 15;
+            uint64_t id, length;
+            if (kind == BINLOG_FORMAT) {
+                if (!BinaryLog::getVarint(p, end, id) || !BinaryLog::getVarint(p, end, length) ||
+                    length > (uint64_t)(end - p) || id > formats.size()) {
+                    return false;
+                }
+                if (id == formats.size()) formats.emplace_back();
+                formats[id].assign(p, length);
+                p += length;
+                continue;
+            }
+
+            uint64_t thread, delta;
+            if (!BinaryLog::getVarint(p, end, thread) || !BinaryLog::getVarint(p, end, delta)) return false;
+            lastTime += (time_t)BinaryLog::unzigzag(delta);
+            const std::string& linePrefix = prefixFor(lastTime);
+
+            if (kind == BINLOG_LINE) {
+                if (!BinaryLog::getVarint(p, end, id) || id >= formats.size() || p >= end) return false;
+                unsigned count = (uint8_t)*p++;
+                BinaryLog::startLine(out, linePrefix, level);
+                if (!BinaryLog::render(out, formats[id], count, p, end, &strings)) return false;
+                out += '\n';
+            } else if (kind == BINLOG_TEXT || kind == BINLOG_LINES) {
+                if (!BinaryLog::getVarint(p, end, length) || length > (uint64_t)(end - p)) return false;
+                BinaryLog::appendText(out, linePrefix, kind, level, std::string_view(p, length));
+                p += length;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // Write the text of the binary log at path to out; false on a read error or damaged data
+    bool decode(const std::string& path, std::ostream& out) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            errorText = "Could not open " + path;
+            return false;
+        }
+
+        std::vector<char> data;
+        std::string text;
+        uint64_t offset = 0;
+        bool headerSeen = false;
+        while (true) {
+            char magic[8];
+            in.read(magic, sizeof(BinaryLogChunkHeader));
+            if (in.gcount() == 0) break;
+            if (in.gcount() < (std::streamsize)sizeof(BinaryLogChunkHeader)) {
+                errorText = path + " ends inside a chunk header at offset " + std::to_string(offset);
+                return false;
+            }
+
+            if (memcmp(magic, "MQBL", 4) == 0) {
+                BinaryLogFileHeader header;
+                memcpy(&header, magic, sizeof(BinaryLogChunkHeader));
+                in.read((char*)&header + sizeof(BinaryLogChunkHeader),
+                        sizeof(header) - sizeof(BinaryLogChunkHeader));
+                if (!in || memcmp(header.magic, "MQBLOG\0\1", sizeof(header.magic)) != 0 ||
+                    header.version != BinaryLog::VERSION) {
+                    errorText = path + " has an unsupported binary log header at offset " + std::to_string(offset);
+                    return false;
+                }
+                reset();
+                headerSeen = true;
+                offset += sizeof(header);
+                continue;
+            }
+
+            BinaryLogChunkHeader header;
+            memcpy(&header, magic, sizeof(header));
+            if (!headerSeen || memcmp(header.magic, "MQLC", 4) != 0) {
+                errorText = headerSeen ? path + " is damaged at offset " + std::to_string(offset)
+                                       : path + " is not a binary log";
+                return false;
+            }
+            data.resize(header.length);
+            in.read(data.data(), header.length);
+            if ((uint32_t)in.gcount() != header.length) {
+                errorText = path + " ends inside the chunk at offset " + std::to_string(offset) +
+                            " (the writer was stopped while writing it)";
+                return false;
+            }
+
+            text.clear();
+            bool complete = decodeChunk(data.data(), data.data() + data.size(), text);
+            out.write(text.data(), (std::streamsize)text.size());
+            if (!complete) {
+                errorText = path + " has a damaged record in the chunk at offset " + std::to_string(offset);
+                return false;
+            }
+            offset += sizeof(header) + header.length;
+        }
+        if (!headerSeen) {
+            errorText = path + " is empty";
+            return false;
+        }
+        return out.good();
+    }
+
+    const std::string& error() const { return errorText; }
+};
+
+#endif // MQ_LOG_FORMAT_H
@@ -0,0 +1,191 @@
+#ifndef MQ_LOG_LIMITER_H
+#define MQ_LOG_LIMITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include "mq_log_format.h"
+
+/**
+ * Log Storm Limiter - Rate limit for errors repeated across a fleet
+ *
+ * During an outage every worker logs the same few errors for every queue
+ * manager and every retry. Such a line is identified by its format (by
+ * address), its MQ reason code and the queue manager it is about. Within
+ * each interval a (format, reason) pair lets through the first line for
+ * each queue manager, up to limit lines in all; later ones are only
+ * counted. Once the interval is over the logger writes one summary per
+ * pair that held lines back:
+ *
+ *     Suppressed 4,212 repeat(s) of "Error reading PCF response (Reason: {})"
+ *     (Reason: 2059) across 380 queue manager(s) in the last 60 s
+ *
+ * so an outage costs at most limit + 1 lines per pair and interval however
+ * large the fleet, and a suppressed line costs one hash lookup. A limit of
+ * 0 lets every line through.
+ */
+class LogStormLimiter {
+public:
+    struct Summary {
+        LogLevel level;
+        const char* format;
+        long reason;
+        size_t suppressed;
+        size_t subjects;        // Distinct queue managers among the suppressed lines
+        long seconds;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Key {
+        const char* format;
+        long reason;
+        bool operator==(const Key& other) const { return format == other.format && reason == other.reason; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.format) * 31 + std::hash<long>()(key.reason);
+        }
+    };
+
+    struct Storm {
+        LogLevel level = LogLevel::Error;
+        Clock::time_point windowStart;
+        std::vector<size_t> logged;                 // Subjects let through this interval (at most limit)
+        std::unordered_set<size_t> suppressedSubjects;
+        size_t suppressed = 0;
+    };
+
+    static constexpr int64_t NOT_DUE = std::numeric_limits<int64_t>::max();
+
+    std::mutex mutex;
+    std::unordered_map<Key, Storm, KeyHash> storms;
+    std::vector<Summary> ready;                     // Summaries of intervals closed by allow()
+    std::atomic<size_t> limit{5};
+    Clock::duration interval = std::chrono::seconds(60);
+    std::atomic<int64_t> nextDue{NOT_DUE};         // Clock ticks when the next summary is owed
+
+    static int64_t ticks(Clock::time_point when) { return (int64_t)when.time_since_epoch().count(); }
+
+    void noteDue(Clock::time_point when) {
+        int64_t due = ticks(when);
+        int64_t current = nextDue.load();
+        while (due < current && !nextDue.compare_exchange_weak(current, due)) {}
+    }
+
+    Summary summaryOf(const Key& key, const Storm& storm, Clock::time_point now) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - storm.windowStart).count();
+        return Summary{storm.level, key.format, key.reason, storm.suppressed,
+                       storm.suppressedSubjects.size(), (long)std::max<long long>(1, elapsed)};
+    }
+
+    static void restart(Storm& storm, Clock::time_point now) {
+        storm.windowStart = now;
+        storm.logged.clear();
+        storm.suppressedSubjects.clear();
+        storm.suppressed = 0;
+    }
+
+public:
+    // Set before any line is logged
+    void configure(size_t maxLines, int intervalSeconds) {
+        std::lock_guard<std::mutex> guard(mutex);
+        limit = maxLines;
+        interval = std::chrono::seconds(std::max(1, intervalSeconds));
+    }
+
+    /**
+     * True if the line for subject should be logged; otherwise it is
+     * counted towards its pair's next summary.
+     */
+    bool allow(LogLevel level, const char* format, long reason, std::string_view subject) {
+        if (limit.load(std::memory_order_relaxed) == 0) return true;
+        size_t id = std::hash<std::string_view>()(subject);
+        Clock::time_point now = Clock::now();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        Key key{format, reason};
+        auto it = storms.find(key);
+        if (it == storms.end()) {
+            it = storms.emplace(key, Storm()).first;
+            it->second.level = level;
+            restart(it->second, now);
+        } else if (now - it->second.windowStart >= interval) {
+            if (it->second.suppressed > 0) {
+                ready.push_back(summaryOf(key, it->second, now));
+                nextDue = 0;
+            }
+            restart(it->second, now);
+        }
+
+        Storm& storm = it->second;
+        bool seen = false;
+        for (size_t logged : storm.logged) {
+            if (logged == id) { seen = true; break; }
+        }
+        if (!seen && storm.logged.size() < limit.load(std::memory_order_relaxed)) {
+            storm.logged.push_back(id);
+            return true;
+        }
+        if (storm.suppressed++ == 0) noteDue(storm.windowStart + interval);
+        storm.suppressedSubjects.insert(id);
+        return false;
+    }
+
+    // Whether a summary is owed; cheap enough to ask on every batch
+    bool due() const {
+        int64_t next = nextDue.load(std::memory_order_relaxed);
+        return next != NOT_DUE && next <= ticks(Clock::now());
+    }
+
+    /**
+     * Move the summaries of every finished interval (of every interval if
+     * all is set, e.g. at shutdown) to out and start those pairs afresh.
+     */
+    void collect(std::vector<Summary>& out, bool all = false) {
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> guard(mutex);
+        out.insert(out.end(), ready.begin(), ready.end());
+        ready.clear();
+
+        int64_t next = NOT_DUE;
+        for (auto it = storms.begin(); it != storms.end();) {
+            Storm& storm = it->second;
+            bool finished = now - storm.windowStart >= interval;
+            if (storm.suppressed > 0 && (finished || all)) {
+                out.push_back(summaryOf(it->first, storm, now));
+                restart(storm, now);
+            } else if (finished) {
+                it = storms.erase(it);
+                continue;
+            } else if (storm.suppressed > 0) {
+                next = std::min(next, ticks(storm.windowStart + interval));
+            }
+            ++it;
+        }
+        nextDue = next;
+    }
+
+    // "4,212"
+    static std::string grouped(size_t count) {
+        std::string digits = std::to_string(count);
+        std::string out;
+        for (size_t i = 0; i < digits.size(); i++) {
+            if (i > 0 && (digits.size() - i) % 3 == 0) out += ',';
+            out += digits[i];
+        }
+        return out;
+    }
+};
+
+#endif // MQ_LOG_LIMITER_H
@@ -0,0 +1,187 @@
+#ifndef MQ_PCF_FILTER_H
+#define MQ_PCF_FILTER_H
+
+#include <cmqc.h>
+#include <cmqcfc.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <limits>
+
+/**
+ * PCF Status Filter - Server-side filtering for MQCMD_INQUIRE_Q_STATUS
+ *
+ * Each generic queue name ("APP*", "ORDERS.IN") becomes the Q_NAME parameter
+ * of its own status inquiry, and an integer condition such as "CURDEPTH GT 0"
+ * is sent as an MQCFIF, so the command server only replies for queues that
+ * match instead of returning every queue on the queue manager.
+ */
+struct PCFStatusFilter {
+    std::vector<std::string> queueNames{"*"};
+    bool hasCondition = false;
+    MQLONG attribute = 0;      // MQIA_* selector of the condition
+    MQLONG op = 0;             // MQCFOP_* operator
+    MQLONG value = 0;
+    std::string conditionText;
+
+    bool isFiltering() const {
+        return hasCondition || queueNames.size() != 1 || queueNames[0] != "*";
+    }
+
+    std::string describe() const {
+        std::string text = "Q_NAME in (";
+        for (size_t i = 0; i < queueNames.size(); i++) {
+            if (i > 0) text += ", ";
+            text += queueNames[i];
+        }
+        text += ")";
+        if (hasCondition) text += " and " + conditionText;
+        return text;
+    }
+
+    /**
+     * Parse a comma-separated list of queue names or generic names (trailing
+     * '*'). Names already covered by a broader generic name are dropped so
+     * the inquiries never return the same queue twice.
+     */
+    static bool parseQueueNames(const std::string& list, std::vector<std::string>& names,
+                                std::string& error) {
+        std::vector<std::string> parsed;
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t end = list.find(',', start);
+            if (end == std::string::npos) end = list.size();
+            std::string name = trim(list.substr(start, end - start));
+            start = end + 1;
+            if (name.empty()) continue;
+
+            size_t star = name.find('*');
+            if (star != std::string::npos && star != name.size() - 1) {
+                error = "generic queue name '" + name + "' may only end with '*'";
+                return false;
+            }
+            if (name.size() > MQ_Q_NAME_LENGTH) {
+                error = "queue name '" + name + "' is longer than " +
+                        std::to_string(MQ_Q_NAME_LENGTH) + " characters";
+                return false;
+            }
+            parsed.push_back(name);
+        }
+
+        if (parsed.empty()) {
+            names = {"*"};
+            return true;
+        }
+
+        // Broadest patterns first (shortest prefix, and "ABC*" before "ABC"),
+        // then drop anything they already cover
+        std::sort(parsed.begin(), parsed.end(), [](const std::string& a, const std::string& b) {
+            bool aGeneric = a.back() == '*';
+            bool bGeneric = b.back() == '*';
+            size_t aPrefix = a.size() - (aGeneric ? 1 : 0);
+            size_t bPrefix = b.size() - (bGeneric ? 1 : 0);
+            if (aPrefix != bPrefix) return aPrefix < bPrefix;
+            if (aGeneric != bGeneric) return aGeneric;
+            return a < b;
+        });
+        names.clear();
+        for (const auto& name : parsed) {
+            bool covered = false;
+            for (const auto& kept : names) {
+                if (kept.back() == '*' ? name.compare(0, kept.size() - 1, kept, 0, kept.size() - 1) == 0
+                                       : name == kept) {
+                    covered = true;
+                    break;
+                }
+            }
+            if (!covered) names.push_back(name);
+        }
+        return true;
+    }
+
+    /**
+     * Parse "<ATTR> <OP> <value>", e.g. "CURDEPTH GT 0" or "OPPROCS GT 0".
+     * ATTR is CURDEPTH, IPPROCS, OPPROCS or UNCOM; OP is one of the MQSC
+     * operators LT, GT, EQ, NE, LE (NG) or GE (NL).
+     */
+    static bool parseCondition(const std::string& text, PCFStatusFilter& filter,
+                               std::string& error) {
+        std::string attr, op, value;
+        size_t pos = 0;
+        if (!nextToken(text, pos, attr) || !nextToken(text, pos, op) ||
+            !nextToken(text, pos, value) || !trim(text.substr(pos)).empty()) {
+            error = "status filter '" + text + "' must look like 'CURDEPTH GT 0'";
+            return false;
+        }
+
+        for (auto& c : attr) c = (char)toupper((unsigned char)c);
+        for (auto& c : op) c = (char)toupper((unsigned char)c);
+
+        if (attr == "CURDEPTH") filter.attribute = MQIA_CURRENT_Q_DEPTH;
+        else if (attr == "IPPROCS") filter.attribute = MQIA_OPEN_INPUT_COUNT;
+        else if (attr == "OPPROCS") filter.attribute = MQIA_OPEN_OUTPUT_COUNT;
+        else if (attr == "UNCOM") filter.attribute = MQIACF_UNCOMMITTED_MSGS;
+        else {
+            error = "unsupported status filter attribute '" + attr +
+                    "' (use CURDEPTH, IPPROCS, OPPROCS or UNCOM)";
+            return false;
+        }
+
+        if (op == "LT") filter.op = MQCFOP_LESS;
+        else if (op == "GT") filter.op = MQCFOP_GREATER;
+        else if (op == "EQ") filter.op = MQCFOP_EQUAL;
+        else if (op == "NE") filter.op = MQCFOP_NOT_EQUAL;
+        else if (op == "LE" || op == "NG") filter.op = MQCFOP_NOT_GREATER;
+        else if (op == "GE" || op == "NL") filter.op = MQCFOP_NOT_LESS;
+        else {
+            error = "unsupported status filter operator '" + op + "' (use LT, GT, EQ, NE, LE or GE)";
+            return false;
+        }
+
+        long long number = 0;
+        try {
+            size_t used = 0;
+            number = std::stoll(value, &used);
+            if (used != value.size()) throw std::invalid_argument(value);
+        } catch (const std::invalid_argument&) {
+            error = "status filter value '" + value + "' is not an integer";
+            return false;
+        } catch (const std::out_of_range&) {
+            number = std::numeric_limits<long long>::max();
+        }
+        // The command server compares 32-bit values; a cast would silently wrap (4294967296 -> 0)
+        if (number < std::numeric_limits<MQLONG>::min() || number > std::numeric_limits<MQLONG>::max()) {
+            error = "status filter value '" + value + "' is out of range (" +
+                    std::to_string(std::numeric_limits<MQLONG>::min()) + " to " +
+                    std::to_string(std::numeric_limits<MQLONG>::max()) + ")";
+            return false;
+        }
+        filter.value = (MQLONG)number;
+
+        filter.hasCondition = true;
+        filter.conditionText = attr + " " + op + " " + value;
+        return true;
+    }
+
+private:
+    static std::string trim(const std::string& str) {
+        size_t first = str.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return "";
+        size_t last = str.find_last_not_of(" \t\r\n");
+        return str.substr(first, (last - first + 1));
+    }
+
+    static bool nextToken(const std::string& text, size_t& pos, std::string& token) {
+        size_t start = text.find_first_not_of(" \t", pos);
+        if (start == std::string::npos) return false;
+        size_t end = text.find_first_of(" \t", start);
+        if (end == std::string::npos) end = text.size();
+        token = text.substr(start, end - start);
+        pos = end;
+        return true;
+    }
+};
+
+#endif // MQ_PCF_FILTER_H
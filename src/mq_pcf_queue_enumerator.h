@@ -17,7 +17,6 @@ class MQPCFQueueEnumerator {
 private:
     MQLog& logger;
     MQHCONN hConn;
-    const int PCF_TIMEOUT = 5000;  // 5 second timeout
 
 public:
     MQPCFQueueEnumerator(MQLog& log, MQHCONN conn) : logger(log), hConn(conn) {}
@@ -41,7 +40,7 @@ public:
         MQOPEN(hConn, &queueDesc, MQOO_BROWSE, &hQueue, &compCode, &reason);
 
         if (compCode != MQCC_OK) {
-            logger.warning("Could not enumerate queues with wildcard (Reason: " + to_string(reason) + ")");
+            logger.warning("Could not enumerate queues with wildcard (Reason: {})", reason);
             logger.info("Using fallback method: querying SYSTEM queues and application queues");
             return getDefaultQueues();
         }
@@ -111,7 +110,7 @@ public:
         }
 
         if (!queues.empty()) {
-            logger.info("Found " + to_string(queues.size()) + " queues using pattern matching");
+            logger.info("Found {} queues using pattern matching", queues.size());
             return queues;
         }
 
@@ -0,0 +1,183 @@
+#ifndef MQ_PCF_READER_H
+#define MQ_PCF_READER_H
+
+#include <cmqc.h>
+#include <cmqcfc.h>
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+
+/**
+ * PCF Reader - Zero-copy decoder for PCF response messages
+ *
+ * Walks the MQCFH header and the parameter structures that follow it in
+ * place. Every structure is bounds-checked against its StrucLength and the
+ * remaining reply length before it is handed out, and string parameters are
+ * returned as trimmed string_views into the reply buffer, so the buffer must
+ * outlive any view taken from it.
+ */
+
+// Trim trailing blanks and NULs from an MQ fixed-length field without copying
+inline std::string_view trimMQView(const char* src, size_t len) {
+    while (len > 0 && (src[len - 1] == ' ' || src[len - 1] == '\0')) {
+        --len;
+    }
+    return std::string_view(src, len);
+}
+
+// Read an MQLONG from a possibly unaligned position in a reply buffer
+inline MQLONG readMQLong(const unsigned char* p) {
+    MQLONG value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * One parameter structure (MQCFIN, MQCFST, ...) located inside a reply
+ */
+struct PCFParameter {
+    MQLONG type = 0;
+    MQLONG parameter = 0;
+    const unsigned char* data = nullptr;  // Start of the structure
+    MQLONG length = 0;                    // Validated StrucLength
+
+    // Value of an MQCFIN (valid when type == MQCFT_INTEGER)
+    MQLONG intValue() const {
+        return readMQLong(data + offsetof(MQCFIN, Value));
+    }
+
+    // Value of an MQCFIN64 (valid when type == MQCFT_INTEGER64)
+    MQINT64 int64Value() const {
+        MQINT64 value;
+        memcpy(&value, data + offsetof(MQCFIN64, Value), sizeof(value));
+        return value;
+    }
+
+    // Trimmed value of an MQCFST (valid when type == MQCFT_STRING)
+    std::string_view stringValue() const {
+        MQLONG strLen = readMQLong(data + offsetof(MQCFST, StringLength));
+        return trimMQView((const char*)data + MQCFST_STRUC_LENGTH_FIXED, (size_t)strLen);
+    }
+
+    // Element count of an MQCFIL or MQCFSL (valid when type is a list type)
+    MQLONG listCount() const {
+        return type == MQCFT_STRING_LIST ? readMQLong(data + offsetof(MQCFSL, Count))
+                                         : readMQLong(data + offsetof(MQCFIL, Count));
+    }
+};
+
+class PCFReader {
+private:
+    const unsigned char* buffer;
+    size_t bufferLength;
+    size_t offset;
+    MQCFH cfh;
+    MQLONG remainingParams;
+    bool headerValid;
+    bool malformed;
+
+public:
+    PCFReader(const unsigned char* data, size_t length)
+        : buffer(data), bufferLength(length), offset(0), remainingParams(0),
+          headerValid(false), malformed(false) {
+        memset(&cfh, 0, sizeof(cfh));
+        if (length < (size_t)MQCFH_STRUC_LENGTH) {
+            malformed = true;
+            return;
+        }
+        memcpy(&cfh, data, sizeof(cfh));
+        if (cfh.StrucLength < MQCFH_STRUC_LENGTH || (size_t)cfh.StrucLength > length ||
+            cfh.ParameterCount < 0) {
+            malformed = true;
+            return;
+        }
+        offset = cfh.StrucLength;
+        remainingParams = cfh.ParameterCount;
+        headerValid = true;
+    }
+
+    bool valid() const { return headerValid; }
+    const MQCFH& header() const { return cfh; }
+
+    // True if a structure failed its bounds checks (the walk stops there)
+    bool isMalformed() const { return malformed; }
+
+    /**
+     * Advance to the next parameter; returns false at the end of the message
+     * or on the first structure whose lengths do not fit the reply.
+     */
+    bool next(PCFParameter& param) {
+        if (!headerValid || malformed || remainingParams <= 0) return false;
+
+        size_t remaining = bufferLength - offset;
+        if (remaining < 2 * sizeof(MQLONG)) {
+            malformed = true;
+            return false;
+        }
+
+        const unsigned char* p = buffer + offset;
+        MQLONG type = readMQLong(p);
+        MQLONG strucLength = readMQLong(p + sizeof(MQLONG));
+        if (strucLength < (MQLONG)(3 * sizeof(MQLONG)) || (size_t)strucLength > remaining) {
+            malformed = true;
+            return false;
+        }
+
+        // Type-specific minimum lengths, so the accessors never read past StrucLength
+        if (type == MQCFT_INTEGER && strucLength < MQCFIN_STRUC_LENGTH) {
+            malformed = true;
+            return false;
+        }
+        if (type == MQCFT_INTEGER64 && strucLength < MQCFIN64_STRUC_LENGTH) {
+            malformed = true;
+            return false;
+        }
+        if (type == MQCFT_STRING) {
+            if (strucLength < MQCFST_STRUC_LENGTH_FIXED) {
+                malformed = true;
+                return false;
+            }
+            MQLONG strLen = readMQLong(p + offsetof(MQCFST, StringLength));
+            if (strLen < 0 || strLen > strucLength - MQCFST_STRUC_LENGTH_FIXED) {
+                malformed = true;
+                return false;
+            }
+        }
+        if (type == MQCFT_INTEGER_LIST) {
+            if (strucLength < MQCFIL_STRUC_LENGTH_FIXED) {
+                malformed = true;
+                return false;
+            }
+            MQLONG count = readMQLong(p + offsetof(MQCFIL, Count));
+            if (count < 0 || (size_t)count * sizeof(MQLONG) >
+                                 (size_t)(strucLength - MQCFIL_STRUC_LENGTH_FIXED)) {
+                malformed = true;
+                return false;
+            }
+        }
+        if (type == MQCFT_STRING_LIST) {
+            if (strucLength < MQCFSL_STRUC_LENGTH_FIXED) {
+                malformed = true;
+                return false;
+            }
+            MQLONG count = readMQLong(p + offsetof(MQCFSL, Count));
+            MQLONG strLen = readMQLong(p + offsetof(MQCFSL, StringLength));
+            if (count < 0 || strLen < 0 ||
+                (size_t)count * (size_t)strLen > (size_t)(strucLength - MQCFSL_STRUC_LENGTH_FIXED)) {
+                malformed = true;
+                return false;
+            }
+        }
+
+        param.type = type;
+        param.parameter = readMQLong(p + 2 * sizeof(MQLONG));
+        param.data = p;
+        param.length = strucLength;
+
+        offset += strucLength;
+        --remainingParams;
+        return true;
+    }
+};
+
+#endif // MQ_PCF_READER_H
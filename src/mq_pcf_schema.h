@@ -0,0 +1,221 @@
+#ifndef MQ_PCF_SCHEMA_H
+#define MQ_PCF_SCHEMA_H
+
+#include <cmqc.h>
+#include <cmqcfc.h>
+#include <string_view>
+#include <optional>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+#include "mq_pcf_reader.h"
+
+/**
+ * PCF Schema - Compile-time description of PCF commands and replies
+ *
+ * Decoding: a reply record is described by a list of PCFField<selector,
+ * &Record::member> entries. The PCF type each entry accepts follows from the
+ * member's C++ type (MQLONG -> MQCFIN, MQINT64 -> MQCFIN64, string_view ->
+ * MQCFST, the list views -> MQCFIL/MQCFSL), and PCFSchema::decode expands the
+ * entries into a fold of comparisons against constant selectors that the
+ * optimizer is free to lower to a jump table; there is no hand-written
+ * switch to keep in sync. Adding an attribute is one member plus one entry.
+ *
+ * Encoding: PCFCommand<command, params...> lays out an MQCFH followed by the
+ * parameters. Every parameter has a fixed length (strings are blank-padded
+ * to their MQ field width), so the command length is a compile-time constant.
+ */
+
+// ---- Decoding ----------------------------------------------------------
+
+// Values of an MQCFIL, read in place
+struct PCFIntegerListView {
+    const unsigned char* values = nullptr;
+    MQLONG count = 0;
+
+    MQLONG operator[](MQLONG i) const { return readMQLong(values + i * sizeof(MQLONG)); }
+};
+
+// Values of an MQCFSL, read in place and trimmed
+struct PCFStringListView {
+    const char* strings = nullptr;
+    MQLONG count = 0;
+    MQLONG stringLength = 0;
+
+    std::string_view operator[](MQLONG i) const {
+        return trimMQView(strings + (size_t)i * stringLength, (size_t)stringLength);
+    }
+};
+
+// PCF structure type that fills a destination of type T
+template <typename T> struct PCFTypeOf;
+template <> struct PCFTypeOf<MQLONG> { static constexpr MQLONG value = MQCFT_INTEGER; };
+template <> struct PCFTypeOf<std::optional<MQLONG>> { static constexpr MQLONG value = MQCFT_INTEGER; };
+template <> struct PCFTypeOf<MQINT64> { static constexpr MQLONG value = MQCFT_INTEGER64; };
+template <> struct PCFTypeOf<std::string_view> { static constexpr MQLONG value = MQCFT_STRING; };
+template <> struct PCFTypeOf<PCFIntegerListView> { static constexpr MQLONG value = MQCFT_INTEGER_LIST; };
+template <> struct PCFTypeOf<PCFStringListView> { static constexpr MQLONG value = MQCFT_STRING_LIST; };
+
+template <typename T> struct PCFMemberTraits;
+template <typename Record, typename T> struct PCFMemberTraits<T Record::*> {
+    using record_type = Record;
+    using value_type = T;
+};
+
+/**
+ * One schema entry: parameter Selector is stored into member Field
+ */
+template <MQLONG Selector, auto Field>
+struct PCFField {
+    using Traits = PCFMemberTraits<decltype(Field)>;
+    using Value = typename Traits::value_type;
+
+    static constexpr MQLONG selector = Selector;
+    static constexpr MQLONG type = PCFTypeOf<Value>::value;
+
+    // Store the parameter if its structure type matches; false otherwise
+    static bool store(const PCFParameter& p, typename Traits::record_type& record) {
+        if (p.type != type) return false;
+        Value& dst = record.*Field;
+        if constexpr (std::is_same_v<Value, MQLONG> || std::is_same_v<Value, std::optional<MQLONG>>) {
+            dst = p.intValue();
+        } else if constexpr (std::is_same_v<Value, MQINT64>) {
+            dst = p.int64Value();
+        } else if constexpr (std::is_same_v<Value, std::string_view>) {
+            dst = p.stringValue();
+        } else if constexpr (std::is_same_v<Value, PCFIntegerListView>) {
+            dst.values = p.data + MQCFIL_STRUC_LENGTH_FIXED;
+            dst.count = p.listCount();
+        } else {
+            dst.strings = (const char*)p.data + MQCFSL_STRUC_LENGTH_FIXED;
+            dst.count = p.listCount();
+            dst.stringLength = readMQLong(p.data + offsetof(MQCFSL, StringLength));
+        }
+        return true;
+    }
+};
+
+template <typename Record, typename... Fields>
+struct PCFSchema {
+    static_assert((std::is_same_v<typename Fields::Traits::record_type, Record> && ...),
+                  "every PCFField must target the schema's record type");
+
+    // Store one parameter into the entry with its selector; unknown selectors are ignored
+    static void decode(const PCFParameter& p, Record& record) {
+        (void)((p.parameter == Fields::selector && Fields::store(p, record)) || ...);
+    }
+
+    /**
+     * Decode every parameter of a reply into record. Returns false if the
+     * header is unusable; malformed is set if the walk stopped at a
+     * structure that failed its bounds check (the parsed prefix is kept).
+     */
+    static bool decode(const unsigned char* data, size_t length, Record& record, bool& malformed) {
+        PCFReader reader(data, length);
+        malformed = reader.isMalformed();
+        if (!reader.valid()) return false;
+
+        PCFParameter param;
+        while (reader.next(param)) {
+            decode(param, record);
+        }
+        malformed = reader.isMalformed();
+        return true;
+    }
+};
+
+// ---- Encoding ----------------------------------------------------------
+
+constexpr MQLONG pcfPadded(size_t length) { return (MQLONG)((length + 3) & ~(size_t)3); }
+
+// MQCFST of fixed width; the value is blank-padded to Width characters
+template <MQLONG Selector, size_t Width>
+struct PCFStringParam {
+    using value_type = std::string_view;
+    static constexpr MQLONG length = MQCFST_STRUC_LENGTH_FIXED + pcfPadded(Width);
+
+    static void write(unsigned char* out, std::string_view value) {
+        MQCFST st = {};
+        st.Type = MQCFT_STRING;
+        st.StrucLength = length;
+        st.Parameter = Selector;
+        st.CodedCharSetId = MQCCSI_DEFAULT;
+        st.StringLength = (MQLONG)Width;
+        memcpy(out, &st, MQCFST_STRUC_LENGTH_FIXED);
+        size_t used = value.size() < Width ? value.size() : Width;
+        memcpy(out + MQCFST_STRUC_LENGTH_FIXED, value.data(), used);
+        memset(out + MQCFST_STRUC_LENGTH_FIXED + used, ' ', length - MQCFST_STRUC_LENGTH_FIXED - used);
+    }
+};
+
+// MQCFIN
+template <MQLONG Selector>
+struct PCFIntegerParam {
+    using value_type = MQLONG;
+    static constexpr MQLONG length = MQCFIN_STRUC_LENGTH;
+
+    static void write(unsigned char* out, MQLONG value) {
+        MQCFIN in = {};
+        in.Type = MQCFT_INTEGER;
+        in.StrucLength = length;
+        in.Parameter = Selector;
+        in.Value = value;
+        memcpy(out, &in, sizeof(in));
+    }
+};
+
+// Value of an MQCFIF: the attribute, operator and operand are chosen at run time
+struct PCFIntegerFilter {
+    MQLONG parameter;
+    MQLONG op;
+    MQLONG value;
+};
+
+// MQCFIF
+struct PCFIntegerFilterParam {
+    using value_type = PCFIntegerFilter;
+    static constexpr MQLONG length = MQCFIF_STRUC_LENGTH;
+
+    static void write(unsigned char* out, const PCFIntegerFilter& filter) {
+        MQCFIF fi = {};
+        fi.Type = MQCFT_INTEGER_FILTER;
+        fi.StrucLength = length;
+        fi.Parameter = filter.parameter;
+        fi.Operator = filter.op;
+        fi.FilterValue = filter.value;
+        memcpy(out, &fi, sizeof(fi));
+    }
+};
+
+/**
+ * A PCF command with a fixed parameter list; build() takes one value per
+ * parameter, in order, and writes exactly `length` bytes.
+ */
+template <MQLONG Command, typename... Params>
+struct PCFCommand {
+    static constexpr MQLONG parameterCount = (MQLONG)sizeof...(Params);
+    static constexpr MQLONG length = MQCFH_STRUC_LENGTH + (0 + ... + Params::length);
+
+    static int build(unsigned char* out, size_t capacity, const typename Params::value_type&... values) {
+        static_assert(length > 0, "PCF command length must be positive");
+        if ((size_t)length > capacity) return 0;
+
+        MQCFH cfh = {};
+        cfh.Type = MQCFT_COMMAND;
+        cfh.StrucLength = MQCFH_STRUC_LENGTH;
+        cfh.Version = MQCFH_VERSION_1;
+        cfh.Command = Command;
+        cfh.MsgSeqNumber = 1;
+        cfh.Control = MQCFC_LAST;
+        cfh.CompCode = MQCC_OK;
+        cfh.Reason = MQRC_NONE;
+        cfh.ParameterCount = parameterCount;
+        memcpy(out, &cfh, sizeof(cfh));
+
+        size_t offset = MQCFH_STRUC_LENGTH;
+        ((Params::write(out + offset, values), offset += Params::length), ...);
+        return length;
+    }
+};
+
+#endif // MQ_PCF_SCHEMA_H
@@ -0,0 +1,178 @@
+#ifndef MQ_PCF_SESSION_H
+#define MQ_PCF_SESSION_H
+
+#include <cmqc.h>
+#include <string>
+#include <cstring>
+#include "mq_log.h"
+
+/**
+ * PCF Session - Command and reply queues kept open for a connection
+ *
+ * Opening SYSTEM.ADMIN.COMMAND.QUEUE and creating a dynamic reply queue on
+ * every poll costs several MQI round trips plus object creation on the
+ * queue manager. A session opens both once and keeps them until close(),
+ * so repeated polls only pay for the commands themselves.
+ *
+ * The reply queue comes from the reply_queue setting:
+ *   - empty            a temporary dynamic queue named "PCF.REPLY.*"
+ *   - ending in '*'    a temporary dynamic queue with that name prefix
+ *   - any other name   a predefined local queue, opened shared; replies on
+ *                      it are always matched by CorrelId because other
+ *                      clients may be using the same queue
+ *
+ * If an MQI call reports that the connection or an object handle is no
+ * longer usable, invalidate() closes the queues (a dynamic reply queue is
+ * deleted if the connection still works) and the next ensureOpen() opens
+ * them again.
+ */
+class MQPCFSession {
+private:
+    MQLog& logger;
+    MQHCONN hConn;
+    std::string replyQueueSetting;
+    MQHOBJ hCmdQueue = MQHO_UNUSABLE_HOBJ;
+    MQHOBJ hReplyQueue = MQHO_UNUSABLE_HOBJ;
+    char replyQName[MQ_Q_NAME_LENGTH + 1] = {0};
+    bool permanentReplyQueue = false;
+    bool isOpen = false;
+    size_t openCount = 0;
+    MQLONG failure = MQRC_NONE;
+
+public:
+    MQPCFSession(MQLog& log, MQHCONN conn, const std::string& replyQueue = "")
+        : logger(log), hConn(conn), replyQueueSetting(replyQueue) {
+        permanentReplyQueue = !replyQueue.empty() && replyQueue.back() != '*';
+    }
+
+    ~MQPCFSession() { close(); }
+
+    MQPCFSession(const MQPCFSession&) = delete;
+    MQPCFSession& operator=(const MQPCFSession&) = delete;
+
+    /**
+     * Open the command and reply queues unless they are already open.
+     * Returns false if either could not be opened.
+     */
+    bool ensureOpen() {
+        if (isOpen) return true;
+
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+
+        // Open command queue
+        MQOD cmdQueueDesc = {MQOD_DEFAULT};
+        strncpy(cmdQueueDesc.ObjectName, "SYSTEM.ADMIN.COMMAND.QUEUE", MQ_Q_NAME_LENGTH);
+
+        MQOPEN(hConn, &cmdQueueDesc, MQOO_OUTPUT | MQOO_FAIL_IF_QUIESCING, &hCmdQueue, &compCode, &reason);
+        if (compCode != MQCC_OK) {
+            logger.error("Failed to open SYSTEM.ADMIN.COMMAND.QUEUE (Reason: {})", reason);
+            hCmdQueue = MQHO_UNUSABLE_HOBJ;
+            if (isSessionFatal(reason)) failure = reason;
+            return false;
+        }
+
+        MQOD replyQueueDesc = {MQOD_DEFAULT};
+        MQLONG openOptions = MQOO_FAIL_IF_QUIESCING;
+        if (permanentReplyQueue) {
+            strncpy(replyQueueDesc.ObjectName, replyQueueSetting.c_str(), MQ_Q_NAME_LENGTH);
+            openOptions |= MQOO_INPUT_SHARED;
+        } else {
+            // Create dynamic reply queue
+            strncpy(replyQueueDesc.ObjectName, "SYSTEM.DEFAULT.MODEL.QUEUE", MQ_Q_NAME_LENGTH);
+            strncpy(replyQueueDesc.DynamicQName,
+                    replyQueueSetting.empty() ? "PCF.REPLY.*" : replyQueueSetting.c_str(), MQ_Q_NAME_LENGTH);
+            openOptions |= MQOO_INPUT_EXCLUSIVE;
+        }
+
+        MQOPEN(hConn, &replyQueueDesc, openOptions, &hReplyQueue, &compCode, &reason);
+        if (compCode != MQCC_OK) {
+            if (permanentReplyQueue) {
+                logger.error("Failed to open reply queue {} (Reason: {})", replyQueueSetting, reason);
+            } else {
+                logger.error("Failed to create dynamic reply queue (Reason: {})", reason);
+            }
+            hReplyQueue = MQHO_UNUSABLE_HOBJ;
+            if (isSessionFatal(reason)) failure = reason;
+            MQCLOSE(hConn, &hCmdQueue, MQCO_NONE, &compCode, &reason);
+            hCmdQueue = MQHO_UNUSABLE_HOBJ;
+            return false;
+        }
+
+        memset(replyQName, 0, sizeof(replyQName));
+        memcpy(replyQName, replyQueueDesc.ObjectName, MQ_Q_NAME_LENGTH);
+        for (int i = MQ_Q_NAME_LENGTH - 1; i >= 0 && (replyQName[i] == ' ' || replyQName[i] == '\0'); i--) {
+            replyQName[i] = '\0';
+        }
+
+        isOpen = true;
+        openCount++;
+        failure = MQRC_NONE;
+        if (permanentReplyQueue) {
+            logger.info("Opened PCF session with shared reply queue {} (replies matched by CorrelId)",
+                        replyQName);
+        } else {
+            logger.info("Created dynamic reply queue: {}", replyQName);
+        }
+        return true;
+    }
+
+    // Close both queues; a dynamic reply queue is deleted with any replies left on it
+    void close() {
+        if (!isOpen) return;
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+        MQCLOSE(hConn, &hCmdQueue, MQCO_NONE, &compCode, &reason);
+        MQCLOSE(hConn, &hReplyQueue, permanentReplyQueue ? MQCO_NONE : MQCO_DELETE_PURGE, &compCode, &reason);
+        hCmdQueue = MQHO_UNUSABLE_HOBJ;
+        hReplyQueue = MQHO_UNUSABLE_HOBJ;
+        isOpen = false;
+    }
+
+    // True for reasons after which the session's handles cannot be used again
+    static bool isSessionFatal(MQLONG reason) {
+        switch (reason) {
+            case MQRC_CONNECTION_BROKEN:
+            case MQRC_HCONN_ERROR:
+            case MQRC_HOBJ_ERROR:
+            case MQRC_OBJECT_CHANGED:
+            case MQRC_Q_MGR_QUIESCING:
+            case MQRC_Q_MGR_STOPPING:
+            case MQRC_CONNECTION_QUIESCING:
+            case MQRC_Q_MGR_NOT_AVAILABLE:
+            case MQRC_RECONNECT_FAILED:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Drop the handles after a fatal reason; the next ensureOpen() reopens.
+     * The queues are closed first, ignoring failures: after HOBJ_ERROR or
+     * OBJECT_CHANGED the connection still works and would otherwise keep a
+     * dynamic reply queue on the queue manager.
+     */
+    void invalidate(MQLONG reason) {
+        if (!isOpen || !isSessionFatal(reason)) return;
+        failure = reason;
+        logger.warning("PCF session handles unusable (Reason: {}), reopening on next poll", reason);
+        close();
+    }
+
+    MQHCONN connection() const { return hConn; }
+    MQHOBJ commandQueue() const { return hCmdQueue; }
+    MQHOBJ replyQueue() const { return hReplyQueue; }
+    const char* replyQueueName() const { return replyQName; }
+
+    // Other clients may read the reply queue too: never take a reply by position
+    bool sharedReplyQueue() const { return permanentReplyQueue; }
+
+    // Number of times the queues were opened (1 for a healthy long-lived session)
+    size_t opens() const { return openCount; }
+
+    // Reason that last invalidated the session (or failed to open it), MQRC_NONE while it is healthy
+    MQLONG failureReason() const { return failure; }
+};
+
+#endif // MQ_PCF_SESSION_H
@@ -5,10 +5,23 @@
 #include <cmqcfc.h>
 #include <string>
 #include <vector>
-#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <string_view>
+#include <optional>
+#include <chrono>
 #include "mq_log.h"
-
+#include "mq_pcf_reader.h"
+#include "mq_pcf_schema.h"
+#include "mq_reply_buffer_pool.h"
+#include "mq_pcf_filter.h"
+#include "mq_string_interner.h"
+#include "mq_pcf_session.h"
+#include <memory>
+
+// A materialized output row; owns its strings, so it outlives the poll and the inquirer
 struct PCFQueueData {
     std::string queueName;
     MQLONG currentDepth;
@@ -24,447 +37,955 @@ struct PCFQueueData {
     std::string role;         // "Reader", "Writer", "Reader/Writer", or "N/A"
 };
 
-// Internal struct to hold per-handle info from MQCMD_INQUIRE_Q_STATUS with HANDLE status type
-struct PCFHandleData {
-    std::string queueName;
-    std::string connection;
-    std::string user;
-    std::string applicationTag;
-    std::string channelName;
+// Zero-copy view of a queue-level status reply; string_views point into the reply buffer
+struct PCFQueueView {
+    std::string_view queueName;
+    MQLONG currentDepth = 0;
+    MQLONG openInputCount = 0;
+    MQLONG openOutputCount = 0;
+    MQLONG queueType = MQQT_LOCAL;
+};
+
+// Zero-copy view of a handle-level status reply; string_views point into the reply buffer
+struct PCFHandleView {
+    std::string_view queueName;
+    std::string_view connection;
+    std::string_view user;
+    std::string_view applicationTag;
+    std::string_view channelName;
+    MQLONG processId = 0;
+    MQLONG openOptions = 0;
+    std::optional<MQLONG> applType;  // Absent on older command servers
+};
+
+// Per-handle info kept after parsing: repeated strings are StringInterner IDs
+// (StringInterner::EMPTY when the attribute was blank or missing); codes stay
+// numeric and are only turned into text by the output sinks
+struct PCFHandleRecord {
+    static constexpr MQLONG NO_APPL_TYPE = -2147483647 - 1;
+
+    uint32_t connection;
+    uint32_t user;
+    uint32_t applicationTag;
+    uint32_t channelName;
+    MQLONG applType;      // MQAT_*, or NO_APPL_TYPE when not reported
     MQLONG processId;
     MQLONG openOptions;
-    std::string processType;  // Application type from MQIACF_APPL_TYPE
-    std::string role;         // Derived: "Reader" or "Writer"
+};
+
+// Queue names listed by an INQUIRE_Q_NAMES reply
+struct PCFQueueNamesView {
+    PCFStringListView queueNames;
+};
+
+// Reply schemas: one entry per attribute decoded into a view
+using QueueStatusSchema = PCFSchema<PCFQueueView,
+    PCFField<MQCA_Q_NAME,            &PCFQueueView::queueName>,
+    PCFField<MQIA_CURRENT_Q_DEPTH,   &PCFQueueView::currentDepth>,
+    PCFField<MQIA_OPEN_INPUT_COUNT,  &PCFQueueView::openInputCount>,
+    PCFField<MQIA_OPEN_OUTPUT_COUNT, &PCFQueueView::openOutputCount>,
+    PCFField<MQIA_Q_TYPE,            &PCFQueueView::queueType>>;
+
+using HandleStatusSchema = PCFSchema<PCFHandleView,
+    PCFField<MQCA_Q_NAME,            &PCFHandleView::queueName>,
+    PCFField<MQCACH_CONNECTION_NAME, &PCFHandleView::connection>,
+    PCFField<MQCACF_USER_IDENTIFIER, &PCFHandleView::user>,
+    PCFField<MQCACF_APPL_TAG,        &PCFHandleView::applicationTag>,
+    PCFField<MQCACH_CHANNEL_NAME,    &PCFHandleView::channelName>,
+    PCFField<MQIACF_PROCESS_ID,      &PCFHandleView::processId>,
+    PCFField<MQIACF_OPEN_OPTIONS,    &PCFHandleView::openOptions>,
+    PCFField<MQIA_APPL_TYPE,         &PCFHandleView::applType>>;
+
+using QueueNamesSchema = PCFSchema<PCFQueueNamesView,
+    PCFField<MQCACF_Q_NAMES, &PCFQueueNamesView::queueNames>>;
+
+// Command layouts; lengths are compile-time constants
+using QueueNameParam = PCFStringParam<MQCA_Q_NAME, MQ_Q_NAME_LENGTH>;
+using QueueStatusCommand = PCFCommand<MQCMD_INQUIRE_Q_STATUS, QueueNameParam>;
+using FilteredQueueStatusCommand = PCFCommand<MQCMD_INQUIRE_Q_STATUS, QueueNameParam, PCFIntegerFilterParam>;
+using HandleStatusCommand = PCFCommand<MQCMD_INQUIRE_Q_STATUS, QueueNameParam,
+                                       PCFIntegerParam<MQIACF_Q_STATUS_TYPE>>;
+using QueueNamesCommand = PCFCommand<MQCMD_INQUIRE_Q_NAMES, QueueNameParam, PCFIntegerParam<MQIA_Q_TYPE>>;
+
+// One output row: a queue-level record and at most one of its handles, both by reference
+struct PCFStatusRow {
+    const PCFQueueView& queue;
+    const PCFHandleRecord* handle;  // nullptr when no application has the queue open
+    const StringInterner& strings;  // Resolves the handle's string IDs
+
+    std::string_view queueType() const;
+    std::string_view connection() const;
+    std::string_view channelName() const;
+    std::string_view user() const;
+    std::string_view applicationTag() const;
+    MQLONG processId() const;
+    std::string processType() const;
+    std::string_view role() const;
+};
+
+// One PCF command in flight on the shared reply queue
+struct PCFRequest {
+    const char* name;
+    std::vector<PCFReply>* responses;
+    MQBYTE msgId[MQ_MSG_ID_LENGTH];
+    bool complete;
+    bool failed;      // Not sent, or answered with an error; its replies are missing
 };
 
 class MQPCFStatusInquirer {
 private:
     MQLog& logger;
+    std::unique_ptr<MQPCFSession> ownedSession;
+    MQPCFSession* session;
     MQHCONN hConn;
-
-    // Helper to trim trailing spaces from MQ fixed-length strings
-    static std::string trimMQString(const char* src, int len) {
-        std::string s(src, len);
-        size_t endpos = s.find_last_not_of(" ");
-        if (endpos != std::string::npos)
-            return s.substr(0, endpos + 1);
-        return "";
-    }
-
-    // Send a PCF command and collect all response messages
-    std::vector<std::vector<unsigned char>> sendPCFCommand(
-        MQHOBJ hCmdQueue, MQHOBJ hReplyQueue, const char* replyQName,
-        unsigned char* cmdBuffer, int cmdLen)
+    std::string qmName;
+    ReplyBufferPool replyPool;
+    std::vector<PCFReply> queueResponses;
+    std::vector<PCFReply> handleResponses;
+    std::vector<PCFReply> namesResponses;
+    std::vector<PCFRequest> requests;
+    PCFStatusFilter filter;
+
+    // Join index of the last poll (views into the reply buffers)
+    std::vector<PCFQueueView> queueViews;         // Sorted by name; position is the queue ID
+    std::unordered_map<std::string_view, uint32_t> queueIds;
+    std::vector<PCFHandleRecord> handleRecords;   // In reply order
+    std::vector<uint32_t> handleQueueIds;         // Queue ID of each entry in handleRecords
+    std::vector<PCFHandleRecord> handlesByQueue;  // handleRecords grouped by queue ID
+    std::vector<uint32_t> handleStart;            // Offsets into handlesByQueue, one per queue + 1
+    std::vector<uint32_t> handleCursor;
+
+    // Distinct handle attribute values of the last poll
+    StringInterner strings;
+
+    // Replies left behind by a timed-out poll expire instead of piling up on a kept
+    // reply queue; they live for twice the budget, and at least a minute
+    static constexpr MQLONG MIN_REPLY_EXPIRY_TENTHS = 600;
+
+    // End-to-end budget of one poll; every reply wait gets only what is left of it
+    std::chrono::milliseconds budget{DEFAULT_BUDGET_MS};
+
+    // State of the poll in progress
+    MQHOBJ hReplyQueue = MQHO_UNUSABLE_HOBJ;
+    std::chrono::steady_clock::time_point pollStart;
+    std::chrono::steady_clock::time_point deadline;
+    bool partial = false;
+    size_t incompleteRequests = 0;
+    size_t sentRequests = 0;
+    size_t allocationsBefore = 0;
+    size_t repliesBefore = 0;
+    size_t bytesBefore = 0;
+    size_t retriesBefore = 0;
+
+    // Put a PCF command without waiting; replies are matched to it by CorrelId
+    bool putPCFCommand(MQHOBJ hCmdQueue, const char* replyQName,
+                       unsigned char* cmdBuffer, int cmdLen, PCFRequest& request)
     {
-        std::vector<std::vector<unsigned char>> responses;
-
         MQLONG compCode = MQCC_OK;
         MQLONG reason = MQRC_NONE;
 
         MQMD cmdMsgDesc = {MQMD_DEFAULT};
         memcpy(cmdMsgDesc.Format, MQFMT_ADMIN, sizeof(cmdMsgDesc.Format));
         cmdMsgDesc.MsgType = MQMT_REQUEST;
+        // Command server copies our MsgId into the CorrelId of every reply
+        cmdMsgDesc.Report = MQRO_NEW_MSG_ID | MQRO_COPY_MSG_ID_TO_CORREL_ID | MQRO_PASS_DISCARD_AND_EXPIRY;
+        cmdMsgDesc.Expiry = std::max<MQLONG>(MIN_REPLY_EXPIRY_TENTHS, (MQLONG)(budget.count() / 50));
         strncpy(cmdMsgDesc.ReplyToQ, replyQName, MQ_Q_NAME_LENGTH);
 
         MQPMO putMsgOpts = {MQPMO_DEFAULT};
+        putMsgOpts.Options |= MQPMO_NEW_MSG_ID;
 
         MQPUT(hConn, hCmdQueue, &cmdMsgDesc, &putMsgOpts, cmdLen, cmdBuffer, &compCode, &reason);
         if (compCode != MQCC_OK) {
-            logger.error("Failed to send PCF command (Reason: " + std::to_string(reason) + ")");
-            return responses;
+            logger.errorFor(qmName, reason, "Failed to send PCF {} command (Reason: {})", request.name, reason);
+            session->invalidate(reason);
+            request.complete = true;
+            request.failed = true;
+            return false;
+        }
+
+        memcpy(request.msgId, cmdMsgDesc.MsgId, sizeof(request.msgId));
+        request.complete = false;
+        sentRequests++;
+        return true;
+    }
+
+    /**
+     * Check a reply received for request. An error response or the MQCFC_LAST
+     * reply completes the request; returns true if the reply carries data.
+     */
+    bool acceptReply(const unsigned char* data, MQLONG dataLen, PCFRequest& request) {
+        if (dataLen < MQCFH_STRUC_LENGTH) {
+            logger.warning("Discarding short PCF message ({} bytes)", dataLen);
+            return false;
         }
 
-        bool lastMessage = false;
-        while (!lastMessage) {
-            std::vector<unsigned char> replyBuffer(65536, 0);
+        MQCFH respCFH;
+        memcpy(&respCFH, data, sizeof(respCFH));
+        logger.trace("PCF {} reply: {} bytes, type {}, command {}, comp code {}, reason {}, control {}, {} parameter(s)",
+                     request.name, dataLen, respCFH.Type, respCFH.Command, respCFH.CompCode,
+                     respCFH.Reason, respCFH.Control, respCFH.ParameterCount);
+        if (respCFH.Type != MQCFT_RESPONSE) {
+            logger.warning("Unexpected PCF message type: {}", respCFH.Type);
+            return false;
+        }
+
+        if (respCFH.CompCode == MQCC_FAILED) {
+            if (respCFH.Reason == MQRCCF_NONE_FOUND) {
+                logger.info("PCF {} inquiry matched no queues", request.name);
+            } else {
+                logger.warning("PCF {} response error, reason: {}", request.name, respCFH.Reason);
+                request.failed = true;
+            }
+            request.complete = true;
+            return false;
+        }
+
+        if (respCFH.Control == MQCFC_LAST) request.complete = true;
+        return true;
+    }
+
+    // Request in flight whose MsgId the reply carries as its CorrelId
+    static PCFRequest* findRequest(const MQBYTE* correlId, PCFRequest* requests, size_t requestCount) {
+        for (size_t i = 0; i < requestCount; i++) {
+            if (memcmp(correlId, requests[i].msgId, sizeof(requests[i].msgId)) == 0) return &requests[i];
+        }
+        return nullptr;
+    }
+
+    /**
+     * Collect the replies to every request in flight from the shared reply
+     * queue, demultiplexing them by CorrelId, until each request has seen its
+     * MQCFC_LAST reply or the poll's deadline passes.
+     */
+    void collectPCFReplies(MQHOBJ replyQueue, PCFRequest* inFlight, size_t requestCount)
+    {
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+
+        size_t pending = 0;
+        for (size_t i = 0; i < requestCount; i++) {
+            if (!inFlight[i].complete) pending++;
+        }
+
+        while (pending > 0) {
+            MQLONG windowLength = 0;
+            unsigned char* window = replyPool.window(windowLength);
 
             MQMD replyMsgDesc = {MQMD_DEFAULT};
             MQGMO getMsgOpts = {MQGMO_DEFAULT};
+            getMsgOpts.Version = MQGMO_VERSION_2;
             getMsgOpts.Options = MQGMO_WAIT | MQGMO_CONVERT;
-            getMsgOpts.WaitInterval = 10000;
+            getMsgOpts.MatchOptions = MQMO_NONE;
+            getMsgOpts.WaitInterval = remainingWaitMs();
 
             MQLONG dataLen = 0;
-            MQGET(hConn, hReplyQueue, &replyMsgDesc, &getMsgOpts,
-                  (MQLONG)replyBuffer.size(), replyBuffer.data(), &dataLen, &compCode, &reason);
+            MQGET(hConn, replyQueue, &replyMsgDesc, &getMsgOpts,
+                  windowLength, window, &dataLen, &compCode, &reason);
+
+            if (reason == MQRC_TRUNCATED_MSG_FAILED) {
+                // The message stays on the queue; retry with a window that fits it
+                replyPool.growForTruncated(dataLen);
+                continue;
+            }
 
             if (compCode != MQCC_OK) {
                 if (reason == MQRC_NO_MSG_AVAILABLE) {
-                    logger.info("No more PCF responses (timeout)");
+                    logger.warning("PCF reply deadline reached with {} inquir(ies) still unanswered", pending);
                 } else {
-                    logger.error("Error reading PCF response (Reason: " + std::to_string(reason) + ")");
+                    logger.errorFor(qmName, reason, "Error reading PCF response (Reason: {})", reason);
+                    session->invalidate(reason);
                 }
                 break;
             }
 
-            MQCFH* pRespCFH = (MQCFH*)replyBuffer.data();
-            if (pRespCFH->Type != MQCFT_RESPONSE) {
-                logger.warning("Unexpected PCF message type: " + std::to_string(pRespCFH->Type));
+            PCFRequest* request = findRequest(replyMsgDesc.CorrelId, inFlight, requestCount);
+            if (!request || request->complete) {
+                logger.warning("Discarding PCF reply that matches no command in flight");
                 continue;
             }
 
-            if (pRespCFH->Control == MQCFC_LAST) {
-                lastMessage = true;
+            if (acceptReply(window, dataLen, *request)) {
+                request->responses->push_back(replyPool.commit(dataLen));
             }
+            if (request->complete) pending--;
+        }
+    }
 
-            if (pRespCFH->CompCode == MQCC_FAILED) {
-                logger.warning("PCF response error, reason: " + std::to_string(pRespCFH->Reason));
-                break;
+    /**
+     * Receive the replies to a single request by CorrelId, leaving the
+     * replies of other requests on the queue. Kept replies are appended to
+     * request.responses; otherwise each reply is only valid inside onReply,
+     * as the next one is received into the same window.
+     */
+    template <typename ReplyCallback>
+    bool receiveReplies(MQHOBJ replyQueue, PCFRequest& request, bool keep, ReplyCallback&& onReply)
+    {
+        MQLONG compCode = MQCC_OK;
+        MQLONG reason = MQRC_NONE;
+
+        while (!request.complete) {
+            MQLONG windowLength = 0;
+            unsigned char* window = replyPool.window(windowLength);
+
+            MQMD replyMsgDesc = {MQMD_DEFAULT};
+            memcpy(replyMsgDesc.CorrelId, request.msgId, sizeof(replyMsgDesc.CorrelId));
+            MQGMO getMsgOpts = {MQGMO_DEFAULT};
+            getMsgOpts.Version = MQGMO_VERSION_2;
+            getMsgOpts.Options = MQGMO_WAIT | MQGMO_CONVERT;
+            getMsgOpts.MatchOptions = MQMO_MATCH_CORREL_ID;
+            getMsgOpts.WaitInterval = remainingWaitMs();
+
+            MQLONG dataLen = 0;
+            MQGET(hConn, replyQueue, &replyMsgDesc, &getMsgOpts,
+                  windowLength, window, &dataLen, &compCode, &reason);
+
+            if (reason == MQRC_TRUNCATED_MSG_FAILED) {
+                replyPool.growForTruncated(dataLen);
+                continue;
+            }
+
+            if (compCode != MQCC_OK) {
+                if (reason == MQRC_NO_MSG_AVAILABLE) {
+                    logger.warning("PCF reply deadline reached before the last {} response", request.name);
+                } else {
+                    logger.errorFor(qmName, reason, "Error reading PCF response (Reason: {})", reason);
+                    session->invalidate(reason);
+                }
+                return false;
+            }
+
+            if (!acceptReply(window, dataLen, request)) continue;
+
+            if (keep) {
+                request.responses->push_back(replyPool.commit(dataLen));
+                onReply(request.responses->back());
+            } else {
+                onReply(replyPool.borrow(dataLen));
             }
+        }
+        return true;
+    }
 
-            replyBuffer.resize(dataLen);
-            responses.push_back(std::move(replyBuffer));
+    // Build PCF command for INQUIRE_Q_STATUS (queue-level: depth, IPPROCS, OPPROCS);
+    // generic names select a subset and the optional condition is evaluated by the server
+    static int buildQueueStatusCommand(unsigned char* cmdBuffer, size_t capacity,
+                                       const std::string& qName, const PCFStatusFilter& filter) {
+        if (filter.hasCondition) {
+            return FilteredQueueStatusCommand::build(cmdBuffer, capacity, qName,
+                                                     PCFIntegerFilter{filter.attribute, filter.op, filter.value});
         }
+        return QueueStatusCommand::build(cmdBuffer, capacity, qName);
+    }
 
-        return responses;
+    // Build PCF command for INQUIRE_Q_STATUS with StatusType=HANDLE (per-handle details)
+    static int buildHandleStatusCommand(unsigned char* cmdBuffer, size_t capacity, const std::string& qName) {
+        return HandleStatusCommand::build(cmdBuffer, capacity, qName, MQIACF_Q_HANDLE);
     }
 
-    // Build PCF command for INQUIRE_Q_STATUS (queue-level: depth, IPPROCS, OPPROCS)
-    int buildQueueStatusCommand(unsigned char* cmdBuffer) {
-        memset(cmdBuffer, 0, 4096);
+    // Build PCF command for INQUIRE_Q_NAMES of all local queues (one reply, used for counting)
+    static int buildQueueNamesCommand(unsigned char* cmdBuffer, size_t capacity) {
+        return QueueNamesCommand::build(cmdBuffer, capacity, "*", MQQT_LOCAL);
+    }
 
-        MQCFH* pCFH = (MQCFH*)cmdBuffer;
-        pCFH->Type = MQCFT_COMMAND;
-        pCFH->StrucLength = MQCFH_STRUC_LENGTH;
-        pCFH->Version = MQCFH_VERSION_1;
-        pCFH->Command = MQCMD_INQUIRE_Q_STATUS;
-        pCFH->MsgSeqNumber = 1;
-        pCFH->Control = MQCFC_LAST;
-        pCFH->CompCode = MQCC_OK;
-        pCFH->Reason = MQRC_NONE;
-        pCFH->ParameterCount = 1;
+    // Number of queue names listed in INQUIRE_Q_NAMES replies
+    static size_t countQueueNames(const std::vector<PCFReply>& replies) {
+        size_t count = 0;
+        for (const auto& reply : replies) {
+            PCFQueueNamesView names;
+            bool malformed = false;
+            if (QueueNamesSchema::decode(reply.data, reply.length, names, malformed)) {
+                count += names.queueNames.count;
+            }
+        }
+        return count;
+    }
 
-        int offset = pCFH->StrucLength;
+public:
+    // Display names shared with PCFStatusRow
+    static const char* queueTypeName(MQLONG qType) {
+        switch (qType) {
+            case MQQT_LOCAL:  return "LOCAL";
+            case MQQT_MODEL:  return "MODEL";
+            case MQQT_ALIAS:  return "ALIAS";
+            case MQQT_REMOTE: return "REMOTE";
+            default:          return "UNKNOWN";
+        }
+    }
 
-        // Parameter 1: Queue Name = "*"
-        MQCFST* pQName = (MQCFST*)(cmdBuffer + offset);
-        pQName->Type = MQCFT_STRING;
-        pQName->Parameter = MQCA_Q_NAME;
-        pQName->CodedCharSetId = MQCCSI_DEFAULT;
-        pQName->StringLength = 1;
-        pQName->StrucLength = MQCFST_STRUC_LENGTH_FIXED + ((1 + 3) & ~3);
-        memcpy(pQName->String, "*", 1);
-        offset += pQName->StrucLength;
+    static std::string applTypeName(MQLONG applType) {
+        switch (applType) {
+            case MQAT_CICS:             return "CICS";
+            case MQAT_MVS:              return "MVS";
+            case MQAT_OS400:            return "OS400";
+            case MQAT_UNIX:             return "UNIX";
+            case MQAT_WINDOWS_NT:       return "WINDOWS";
+            case MQAT_JAVA:             return "JAVA";
+            case MQAT_CHANNEL_INITIATOR: return "CHINIT";
+            case MQAT_QMGR:             return "QMGR";
+            case MQAT_USER:             return "USER";
+            case MQAT_BROKER:           return "BROKER";
+            default:                    return "OTHER(" + std::to_string(applType) + ")";
+        }
+    }
 
-        // Default StatusType is MQIACF_Q_STATUS which returns queue-level info
-        return offset;
+    // Determine role from open options
+    static const char* roleName(MQLONG openOptions) {
+        bool isInput = (openOptions & MQOO_INPUT_AS_Q_DEF) ||
+                       (openOptions & MQOO_INPUT_SHARED) ||
+                       (openOptions & MQOO_INPUT_EXCLUSIVE);
+        bool isOutput = (openOptions & MQOO_OUTPUT) != 0;
+
+        if (isInput && isOutput) return "Reader/Writer";
+        if (isInput) return "Reader";
+        if (isOutput) return "Writer";
+        return "N/A";
     }
 
-    // Build PCF command for INQUIRE_Q_STATUS with StatusType=HANDLE (per-handle details)
-    int buildHandleStatusCommand(unsigned char* cmdBuffer) {
-        memset(cmdBuffer, 0, 4096);
-
-        MQCFH* pCFH = (MQCFH*)cmdBuffer;
-        pCFH->Type = MQCFT_COMMAND;
-        pCFH->StrucLength = MQCFH_STRUC_LENGTH;
-        pCFH->Version = MQCFH_VERSION_1;
-        pCFH->Command = MQCMD_INQUIRE_Q_STATUS;
-        pCFH->MsgSeqNumber = 1;
-        pCFH->Control = MQCFC_LAST;
-        pCFH->CompCode = MQCC_OK;
-        pCFH->Reason = MQRC_NONE;
-        pCFH->ParameterCount = 2;
-
-        int offset = pCFH->StrucLength;
-
-        // Parameter 1: Queue Name = "*"
-        MQCFST* pQName = (MQCFST*)(cmdBuffer + offset);
-        pQName->Type = MQCFT_STRING;
-        pQName->Parameter = MQCA_Q_NAME;
-        pQName->CodedCharSetId = MQCCSI_DEFAULT;
-        pQName->StringLength = 1;
-        pQName->StrucLength = MQCFST_STRUC_LENGTH_FIXED + ((1 + 3) & ~3);
-        memcpy(pQName->String, "*", 1);
-        offset += pQName->StrucLength;
-
-        // Parameter 2: StatusType = HANDLE (per-handle info)
-        MQCFIN* pStatusType = (MQCFIN*)(cmdBuffer + offset);
-        pStatusType->Type = MQCFT_INTEGER;
-        pStatusType->StrucLength = MQCFIN_STRUC_LENGTH;
-        pStatusType->Parameter = MQIACF_Q_STATUS_TYPE;
-        pStatusType->Value = MQIACF_Q_HANDLE;
-        offset += pStatusType->StrucLength;
-
-        return offset;
-    }
-
-    // Parse a queue-level status response into PCFQueueData
-    PCFQueueData parseQueueStatusResponse(const std::vector<unsigned char>& data) {
-        PCFQueueData q;
-        q.currentDepth = 0;
-        q.openInputCount = 0;
-        q.openOutputCount = 0;
-        q.queueType = "LOCAL";
-        q.processId = 0;
-        q.connection = "N/A";
-        q.user = "N/A";
-        q.applicationTag = "N/A";
-        q.channelName = "N/A";
-        q.processType = "N/A";
-        q.role = "N/A";
-
-        MQCFH* pCFH = (MQCFH*)data.data();
-        int respOffset = pCFH->StrucLength;
-        MQLONG dataLen = (MQLONG)data.size();
-
-        for (int p = 0; p < pCFH->ParameterCount && respOffset < dataLen; p++) {
-            MQLONG* pType = (MQLONG*)(data.data() + respOffset);
-
-            if (*pType == MQCFT_STRING) {
-                MQCFST* pStr = (MQCFST*)(data.data() + respOffset);
-                if (pStr->Parameter == MQCA_Q_NAME) {
-                    char buf[MQ_Q_NAME_LENGTH + 1] = {0};
-                    int copyLen = pStr->StringLength;
-                    if (copyLen > MQ_Q_NAME_LENGTH) copyLen = MQ_Q_NAME_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    q.queueName = trimMQString(buf, copyLen);
-                }
-                respOffset += pStr->StrucLength;
-            }
-            else if (*pType == MQCFT_INTEGER) {
-                MQCFIN* pInt = (MQCFIN*)(data.data() + respOffset);
-                if (pInt->Parameter == MQIA_CURRENT_Q_DEPTH) {
-                    q.currentDepth = pInt->Value;
-                }
-                else if (pInt->Parameter == MQIA_OPEN_INPUT_COUNT) {
-                    q.openInputCount = pInt->Value;
-                }
-                else if (pInt->Parameter == MQIA_OPEN_OUTPUT_COUNT) {
-                    q.openOutputCount = pInt->Value;
-                }
-                else if (pInt->Parameter == MQIA_Q_TYPE) {
-                    switch (pInt->Value) {
-                        case MQQT_LOCAL:  q.queueType = "LOCAL"; break;
-                        case MQQT_MODEL:  q.queueType = "MODEL"; break;
-                        case MQQT_ALIAS:  q.queueType = "ALIAS"; break;
-                        case MQQT_REMOTE: q.queueType = "REMOTE"; break;
-                        default:          q.queueType = "UNKNOWN"; break;
-                    }
-                }
-                respOffset += pInt->StrucLength;
-            }
-            else {
-                MQLONG structLen = *(MQLONG*)(data.data() + respOffset + sizeof(MQLONG));
-                if (structLen <= 0) break;
-                respOffset += structLen;
-            }
+    static std::string_view orNA(std::string_view value) {
+        return value.empty() ? std::string_view("N/A") : value;
+    }
+
+private:
+
+    // Parse a queue-level status response in place; views point into data
+    bool parseQueueStatusResponse(const PCFReply& data, PCFQueueView& q) {
+        bool malformed = false;
+        if (!QueueStatusSchema::decode(data.data, data.length, q, malformed)) {
+            logger.warning("Discarding malformed queue status response ({} bytes)", data.length);
+            return false;
         }
-        return q;
-    }
-
-    // Parse a handle-level status response into PCFHandleData
-    PCFHandleData parseHandleStatusResponse(const std::vector<unsigned char>& data) {
-        PCFHandleData h;
-        h.connection = "N/A";
-        h.user = "N/A";
-        h.applicationTag = "N/A";
-        h.channelName = "N/A";
-        h.processId = 0;
-        h.openOptions = 0;
-        h.processType = "N/A";
-        h.role = "N/A";
-
-        MQCFH* pCFH = (MQCFH*)data.data();
-        int respOffset = pCFH->StrucLength;
-        MQLONG dataLen = (MQLONG)data.size();
-
-        for (int p = 0; p < pCFH->ParameterCount && respOffset < dataLen; p++) {
-            MQLONG* pType = (MQLONG*)(data.data() + respOffset);
-
-            if (*pType == MQCFT_STRING) {
-                MQCFST* pStr = (MQCFST*)(data.data() + respOffset);
-                int copyLen = pStr->StringLength;
-
-                if (pStr->Parameter == MQCA_Q_NAME) {
-                    char buf[MQ_Q_NAME_LENGTH + 1] = {0};
-                    if (copyLen > MQ_Q_NAME_LENGTH) copyLen = MQ_Q_NAME_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    h.queueName = trimMQString(buf, copyLen);
-                }
-                else if (pStr->Parameter == MQCACH_CONNECTION_NAME) {
-                    char buf[MQ_CONN_NAME_LENGTH + 1] = {0};
-                    if (copyLen > MQ_CONN_NAME_LENGTH) copyLen = MQ_CONN_NAME_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    std::string trimmed = trimMQString(buf, copyLen);
-                    if (!trimmed.empty()) h.connection = trimmed;
-                }
-                else if (pStr->Parameter == MQCACF_USER_IDENTIFIER) {
-                    char buf[MQ_USER_ID_LENGTH + 1] = {0};
-                    if (copyLen > MQ_USER_ID_LENGTH) copyLen = MQ_USER_ID_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    std::string trimmed = trimMQString(buf, copyLen);
-                    if (!trimmed.empty()) h.user = trimmed;
-                }
-                else if (pStr->Parameter == MQCACF_APPL_TAG) {
-                    char buf[MQ_APPL_TAG_LENGTH + 1] = {0};
-                    if (copyLen > MQ_APPL_TAG_LENGTH) copyLen = MQ_APPL_TAG_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    std::string trimmed = trimMQString(buf, copyLen);
-                    if (!trimmed.empty()) h.applicationTag = trimmed;
-                }
-                else if (pStr->Parameter == MQCACH_CHANNEL_NAME) {
-                    char buf[MQ_CHANNEL_NAME_LENGTH + 1] = {0};
-                    if (copyLen > MQ_CHANNEL_NAME_LENGTH) copyLen = MQ_CHANNEL_NAME_LENGTH;
-                    memcpy(buf, pStr->String, copyLen);
-                    std::string trimmed = trimMQString(buf, copyLen);
-                    if (!trimmed.empty()) h.channelName = trimmed;
-                }
+        if (malformed) {
+            logger.warning("Queue status response failed bounds check, keeping parsed prefix");
+        }
+        return true;
+    }
 
-                respOffset += pStr->StrucLength;
-            }
-            else if (*pType == MQCFT_INTEGER) {
-                MQCFIN* pInt = (MQCFIN*)(data.data() + respOffset);
+    // Parse a handle-level status response in place; views point into data
+    bool parseHandleStatusResponse(const PCFReply& data, PCFHandleView& h) {
+        bool malformed = false;
+        if (!HandleStatusSchema::decode(data.data, data.length, h, malformed)) {
+            logger.warning("Discarding malformed handle status response ({} bytes)", data.length);
+            return false;
+        }
+        if (malformed) {
+            logger.warning("Handle status response failed bounds check, keeping parsed prefix");
+        }
+        return true;
+    }
 
-                if (pInt->Parameter == MQIACF_PROCESS_ID) {
-                    h.processId = pInt->Value;
-                }
-                else if (pInt->Parameter == MQIACF_OPEN_OPTIONS) {
-                    h.openOptions = pInt->Value;
-                }
-                else if (pInt->Parameter == MQIA_APPL_TYPE) {
-                    switch (pInt->Value) {
-                        case MQAT_CICS:             h.processType = "CICS"; break;
-                        case MQAT_MVS:              h.processType = "MVS"; break;
-                        case MQAT_OS400:            h.processType = "OS400"; break;
-                        case MQAT_UNIX:             h.processType = "UNIX"; break;
-                        case MQAT_WINDOWS_NT:       h.processType = "WINDOWS"; break;
-                        case MQAT_JAVA:             h.processType = "JAVA"; break;
-                        case MQAT_CHANNEL_INITIATOR: h.processType = "CHINIT"; break;
-                        case MQAT_QMGR:            h.processType = "QMGR"; break;
-                        case MQAT_USER:             h.processType = "USER"; break;
-                        case MQAT_BROKER:           h.processType = "BROKER"; break;
-                        default:                    h.processType = "OTHER(" + std::to_string(pInt->Value) + ")"; break;
-                    }
-                }
+    // Copy a row out of the reply buffers and interner
+    static PCFQueueData materializeRow(const PCFStatusRow& r) {
+        PCFQueueData row;
+        row.queueName = r.queue.queueName;
+        row.currentDepth = r.queue.currentDepth;
+        row.openInputCount = r.queue.openInputCount;
+        row.openOutputCount = r.queue.openOutputCount;
+        row.queueType = r.queueType();
+        row.connection = r.connection();
+        row.user = r.user();
+        row.applicationTag = r.applicationTag();
+        row.channelName = r.channelName();
+        row.processId = r.processId();
+        row.processType = r.processType();
+        row.role = r.role();
+        return row;
+    }
 
-                respOffset += pInt->StrucLength;
+    /**
+     * Parse queue-level replies into queueViews, sorted and de-duplicated by
+     * name so that a queue's position is its interned ID.
+     */
+    void buildQueueIndex() {
+        auto parseStart = std::chrono::steady_clock::now();
+        queueViews.clear();
+        for (const auto& resp : queueResponses) {
+            PCFQueueView q;
+            if (parseQueueStatusResponse(resp, q) && !q.queueName.empty()) {
+                queueViews.push_back(q);
             }
-            else {
-                MQLONG structLen = *(MQLONG*)(data.data() + respOffset + sizeof(MQLONG));
-                if (structLen <= 0) break;
-                respOffset += structLen;
+        }
+
+        // The last reply for a queue wins, as overlapping inquiries describe the same queue
+        std::stable_sort(queueViews.begin(), queueViews.end(),
+                         [](const PCFQueueView& a, const PCFQueueView& b) { return a.queueName < b.queueName; });
+        size_t kept = 0;
+        for (size_t i = 0; i < queueViews.size(); i++) {
+            if (kept > 0 && queueViews[kept - 1].queueName == queueViews[i].queueName) {
+                queueViews[kept - 1] = queueViews[i];
+            } else {
+                queueViews[kept++] = queueViews[i];
             }
         }
+        queueViews.resize(kept);
+
+        queueIds.clear();
+        queueIds.reserve(queueViews.size());
+        for (uint32_t id = 0; id < (uint32_t)queueViews.size(); id++) {
+            queueIds.emplace(queueViews[id].queueName, id);
+        }
+        logParseTiming("queue-level", queueResponses.size(), parseStart);
+        logger.debug("Retrieved {} queue statuses", queueViews.size());
+    }
+
+    /**
+     * Parse the handle-level replies and counting-sort them by queue ID: the
+     * handles of queue i are handlesByQueue[handleStart[i] .. handleStart[i + 1]).
+     * Everything is a flat vector reused across polls.
+     */
+    void buildHandleIndex() {
+        auto parseStart = std::chrono::steady_clock::now();
+        handleRecords.clear();
+        handleQueueIds.clear();
+        handleStart.assign(queueViews.size() + 1, 0);
+        for (const auto& resp : handleResponses) {
+            PCFHandleView h;
+            if (!parseHandleStatusResponse(resp, h) || h.queueName.empty()) continue;
+            auto it = queueIds.find(h.queueName);
+            if (it == queueIds.end()) continue;
+            handleRecords.push_back(internHandle(h));
+            handleQueueIds.push_back(it->second);
+            handleStart[it->second + 1]++;
+        }
+        logParseTiming("handle-level", handleResponses.size(), parseStart);
+        logger.debug("Retrieved {} handle entries", handleResponses.size());
 
-        // Determine role from open options
-        bool isInput = (h.openOptions & MQOO_INPUT_AS_Q_DEF) ||
-                       (h.openOptions & MQOO_INPUT_SHARED) ||
-                       (h.openOptions & MQOO_INPUT_EXCLUSIVE);
-        bool isOutput = (h.openOptions & MQOO_OUTPUT) != 0;
+        // Counting sort by queue ID keeps each queue's handles in reply order
+        for (size_t i = 1; i < handleStart.size(); i++) {
+            handleStart[i] += handleStart[i - 1];
+        }
+        handlesByQueue.resize(handleRecords.size());
+        handleCursor.assign(handleStart.begin(), handleStart.end() - 1);
+        for (size_t i = 0; i < handleRecords.size(); i++) {
+            handlesByQueue[handleCursor[handleQueueIds[i]]++] = handleRecords[i];
+        }
 
-        if (isInput && isOutput)
-            h.role = "Reader/Writer";
-        else if (isInput)
-            h.role = "Reader";
-        else if (isOutput)
-            h.role = "Writer";
+        logDroppedHandles(handleResponses.size() - handleRecords.size());
+    }
 
-        return h;
+    // Keep a parsed handle as interned IDs, so it no longer depends on its reply buffer
+    PCFHandleRecord internHandle(const PCFHandleView& h) {
+        PCFHandleRecord record;
+        record.connection = strings.intern(h.connection);
+        record.user = strings.intern(h.user);
+        record.applicationTag = strings.intern(h.applicationTag);
+        record.channelName = strings.intern(h.channelName);
+        record.applType = h.applType ? *h.applType : PCFHandleRecord::NO_APPL_TYPE;
+        record.processId = h.processId;
+        record.openOptions = h.openOptions;
+        return record;
     }
 
-public:
-    MQPCFStatusInquirer(MQLog& log, MQHCONN conn) : logger(log), hConn(conn) {}
+    void logInternStats() {
+        logger.debug("Interned {} distinct handle strings ({} bytes) for {} handle attribute values",
+                     strings.size() - 1, strings.bytesUsed(), strings.lookupCount());
+    }
 
-    std::vector<PCFQueueData> inquireAllQueueStatuses() {
-        std::vector<PCFQueueData> results;
+    void logDroppedHandles(size_t unmatched) {
+        if (unmatched == 0) return;
+        if (filter.hasCondition) {
+            // Handle status has no depth/IPPROCS attributes to filter on, so these are dropped here
+            logger.info("Dropped {} handle-level replies for queues outside {}", unmatched, filter.conditionText);
+        } else {
+            logger.info("Dropped {} handle-level replies with no matching queue-level status", unmatched);
+        }
+    }
 
-        logger.info("Sending PCF INQUIRE_Q_STATUS commands for queue-level and handle-level status...");
+    void logParseTiming(const char* what, size_t records,
+                        std::chrono::steady_clock::time_point start) {
+        if (!logger.enabled<LogLevel::Debug>()) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        long long perRecord = records ? elapsed / (long long)records : 0;
+        logger.debug("Parsed {} {} replies in {} us ({} ns/record)", records, what, elapsed / 1000, perRecord);
+    }
 
-        // Open command queue
-        MQOD cmdQueueDesc = {MQOD_DEFAULT};
-        strncpy(cmdQueueDesc.ObjectName, "SYSTEM.ADMIN.COMMAND.QUEUE", MQ_Q_NAME_LENGTH);
+    long long msSincePollStart() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - pollStart).count();
+    }
 
-        MQHOBJ hCmdQueue = MQHO_UNUSABLE_HOBJ;
-        MQLONG compCode = MQCC_OK;
-        MQLONG reason = MQRC_NONE;
+    // Wait interval for the next MQGET: what is left of the budget, 0 once it is spent
+    // (replies already on the queue are still taken, nothing more is waited for)
+    MQLONG remainingWaitMs() const {
+        long long left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        return left > 0 ? (MQLONG)left : 0;
+    }
 
-        MQOPEN(hConn, &cmdQueueDesc, MQOO_OUTPUT, &hCmdQueue, &compCode, &reason);
-        if (compCode != MQCC_OK) {
-            logger.error("Failed to open SYSTEM.ADMIN.COMMAND.QUEUE (Reason: " + std::to_string(reason) + ")");
-            return results;
+    // Flag the poll as partial if any inquiry failed or is still waiting for replies
+    void checkCompleteness() {
+        incompleteRequests = 0;
+        for (const auto& request : requests) {
+            if (request.failed || !request.complete) incompleteRequests++;
+        }
+        if (incompleteRequests == 0) return;
+        partial = true;
+        logger.warning("Partial result: {} of {} PCF inquiries incomplete after {} ms (budget {} ms)",
+                       incompleteRequests, requests.size(), msSincePollStart(), budget.count());
+    }
+
+    /**
+     * Open the command queue and a dynamic reply queue and put every inquiry
+     * of the poll. Returns false if the command server could not be reached.
+     */
+    bool startInquiries() {
+        pollStart = std::chrono::steady_clock::now();
+        deadline = pollStart + budget;
+        partial = false;
+        incompleteRequests = 0;
+        sentRequests = 0;
+        requests.clear();
+
+        // Reuse reply storage and the string arena from the previous poll
+        replyPool.reset();
+        strings.clear();
+        queueResponses.clear();
+        handleResponses.clear();
+        namesResponses.clear();
+        allocationsBefore = replyPool.allocationCount();
+        repliesBefore = replyPool.replyCount();
+        bytesBefore = replyPool.bytesReceivedCount();
+        retriesBefore = replyPool.truncationRetryCount();
+
+        logger.debug("Sending PCF INQUIRE_Q_STATUS commands for queue-level and handle-level status...");
+
+        // Command and reply queues stay open across polls
+        if (!session->ensureOpen()) {
+            partial = true;
+            return false;
+        }
+        MQHOBJ hCmdQueue = session->commandQueue();
+        hReplyQueue = session->replyQueue();
+        const char* replyQName = session->replyQueueName();
+
+        // === Step 1: Put the queue-level (depth, IPPROCS, OPPROCS) and handle-level
+        // (connection, channel, user, PID, role) inquiries back-to-back, so both
+        // are answered in one round trip and describe the same moment. Each
+        // queue name of the filter gets its own pair of inquiries. ===
+        bool filtering = filter.isFiltering();
+        for (size_t i = 0; i < filter.queueNames.size(); i++) {
+            requests.push_back({"queue-level", &queueResponses, {0}, true, false});
+            requests.push_back({"handle-level", &handleResponses, {0}, true, false});
+        }
+        if (filtering) {
+            // One INQUIRE_Q_NAMES reply tells how many queue-level replies the filter avoided
+            requests.push_back({"queue-names", &namesResponses, {0}, true, false});
         }
 
-        // Create dynamic reply queue
-        MQOD replyQueueDesc = {MQOD_DEFAULT};
-        strncpy(replyQueueDesc.ObjectName, "SYSTEM.DEFAULT.MODEL.QUEUE", MQ_Q_NAME_LENGTH);
-        strncpy(replyQueueDesc.DynamicQName, "PCF.REPLY.*", MQ_Q_NAME_LENGTH);
+        unsigned char cmdBuffer[512];
+        int cmdLen = 0;
+        for (size_t i = 0; i < filter.queueNames.size(); i++) {
+            cmdLen = buildQueueStatusCommand(cmdBuffer, sizeof(cmdBuffer), filter.queueNames[i], filter);
+            putPCFCommand(hCmdQueue, replyQName, cmdBuffer, cmdLen, requests[2 * i]);
 
-        MQHOBJ hReplyQueue = MQHO_UNUSABLE_HOBJ;
-        MQOPEN(hConn, &replyQueueDesc, MQOO_INPUT_EXCLUSIVE, &hReplyQueue, &compCode, &reason);
-        if (compCode != MQCC_OK) {
-            logger.error("Failed to create dynamic reply queue (Reason: " + std::to_string(reason) + ")");
-            MQCLOSE(hConn, &hCmdQueue, MQCO_NONE, &compCode, &reason);
-            return results;
+            cmdLen = buildHandleStatusCommand(cmdBuffer, sizeof(cmdBuffer), filter.queueNames[i]);
+            putPCFCommand(hCmdQueue, replyQName, cmdBuffer, cmdLen, requests[2 * i + 1]);
+        }
+        if (filtering) {
+            cmdLen = buildQueueNamesCommand(cmdBuffer, sizeof(cmdBuffer));
+            putPCFCommand(hCmdQueue, replyQName, cmdBuffer, cmdLen, requests.back());
+        }
+
+        logger.debug("Sent queue-level and handle-level status inquiries, collecting replies...");
+        return true;
+    }
+
+    void logFilterEffect() {
+        if (!filter.isFiltering()) return;
+        if (namesResponses.empty()) {
+            logger.info("Server-side filter {}: {} queue-level replies (queue count unavailable, avoided replies unknown)",
+                        filter.describe(), queueResponses.size());
+        } else {
+            size_t totalQueues = countQueueNames(namesResponses);
+            size_t avoided = totalQueues > queueResponses.size() ? totalQueues - queueResponses.size() : 0;
+            logger.info("Server-side filter {}: {} of {} local queues returned, {} queue-level replies avoided",
+                        filter.describe(), queueResponses.size(), totalQueues, avoided);
         }
+    }
 
-        char replyQName[MQ_Q_NAME_LENGTH + 1] = {0};
-        memcpy(replyQName, replyQueueDesc.ObjectName, MQ_Q_NAME_LENGTH);
-        logger.info("Created dynamic reply queue: " + std::string(replyQName));
+    // The session keeps the queues open; only the per-poll statistics are reported
+    void finishInquiries() {
+        logger.debug("Reply buffers: {} replies, {} KiB received into {} KiB of pooled slabs, "
+                     "{} new allocation(s), {} truncation retr(ies), receive window {} bytes",
+                     replyPool.replyCount() - repliesBefore,
+                     (replyPool.bytesReceivedCount() - bytesBefore) / 1024,
+                     replyPool.capacity() / 1024, replyPool.allocationCount() - allocationsBefore,
+                     replyPool.truncationRetryCount() - retriesBefore, replyPool.receiveWindowSize());
+    }
 
-        // === Step 1: Queue-level status (depth, IPPROCS, OPPROCS) ===
-        unsigned char cmdBuffer[4096];
-        int cmdLen = buildQueueStatusCommand(cmdBuffer);
+    /**
+     * Run one buffered poll: put the inquiries, collect every reply and parse
+     * them into the join index. Returns false if the command server could not
+     * be reached.
+     */
+    bool pollQueueStatuses() {
+        if (!startInquiries()) return false;
+
+        if (session->sharedReplyQueue()) {
+            // Other clients' replies may be on the queue: take ours by CorrelId, one request at a time
+            auto noop = [](const PCFReply&) {};
+            for (auto& request : requests) {
+                receiveReplies(hReplyQueue, request, true, noop);
+            }
+        } else {
+            collectPCFReplies(hReplyQueue, requests.data(), requests.size());
+        }
+        indexCollectedReplies();
+        return true;
+    }
 
-        logger.info("Sending queue-level status inquiry...");
-        auto queueResponses = sendPCFCommand(hCmdQueue, hReplyQueue, replyQName, cmdBuffer, cmdLen);
+    // Report on the replies of a buffered poll and parse them into the join index
+    void indexCollectedReplies() {
+        logger.info("Collected {} queue-level and {} handle-level replies in {} ms",
+                    queueResponses.size(), handleResponses.size(), msSincePollStart());
+        checkCompleteness();
+        logFilterEffect();
+        finishInquiries();
+
+        // === Step 2: Parse the replies in place and index handles by queue ===
+        buildQueueIndex();
+        buildHandleIndex();
+    }
 
-        // Parse queue-level data into a map by queue name
-        std::map<std::string, PCFQueueData> queueMap;
-        for (const auto& resp : queueResponses) {
-            PCFQueueData q = parseQueueStatusResponse(resp);
-            if (!q.queueName.empty()) {
-                queueMap[q.queueName] = q;
+    // === Step 3: Merge - walk queues in order, each with its contiguous run of handles ===
+    template <typename RowCallback>
+    size_t emitJoinedRows(RowCallback&& onRow) {
+        auto mergeStart = std::chrono::steady_clock::now();
+        size_t rows = 0;
+        for (uint32_t id = 0; id < (uint32_t)queueViews.size(); id++) {
+            const PCFQueueView& queue = queueViews[id];
+            uint32_t first = handleStart[id];
+            uint32_t last = handleStart[id + 1];
+            if (first == last) {
+                // No open handles - emit single row with defaults
+                onRow(PCFStatusRow{queue, nullptr, strings});
+                rows++;
+            }
+            for (uint32_t h = first; h < last; h++) {
+                onRow(PCFStatusRow{queue, &handlesByQueue[h], strings});
+                rows++;
             }
         }
-        logger.info("Retrieved " + std::to_string(queueMap.size()) + " queue statuses");
+        auto mergeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - mergeStart).count();
+        logger.debug("Joined {} queues with {} handles into {} rows in {} us", queueViews.size(),
+                     handleStart.empty() ? 0 : handleStart.back(), rows, mergeUs);
+
+        logInternStats();
+        logger.info("Final result: {} rows (queues + handles)", rows);
+        return rows;
+    }
 
-        // === Step 2: Handle-level status (per-handle: connection, channel, user, PID, role) ===
-        cmdLen = buildHandleStatusCommand(cmdBuffer);
+public:
+    // Poll budget used unless setReplyBudget() is called
+    static constexpr int DEFAULT_BUDGET_MS = 30000;
+
+    // Inquirer with its own session (dynamic reply queue), kept for the inquirer's lifetime
+    MQPCFStatusInquirer(MQLog& log, MQHCONN conn, const std::string& qm = "")
+        : logger(log), ownedSession(new MQPCFSession(log, conn)), session(ownedSession.get()),
+          hConn(conn), qmName(qm), replyPool(qm) {}
+
+    // Inquirer polling through a session owned by the caller, e.g. one per pooled connection
+    MQPCFStatusInquirer(MQLog& log, MQPCFSession& pcfSession, const std::string& qm = "")
+        : logger(log), session(&pcfSession), hConn(pcfSession.connection()), qmName(qm), replyPool(qm) {}
+
+    // Restrict the inquiries to matching queues on the command server
+    void setFilter(const PCFStatusFilter& statusFilter) { filter = statusFilter; }
+
+    /**
+     * End-to-end time allowed for one poll, from putting the inquiries to the
+     * last reply. Each reply wait uses only the remaining budget, so a slow or
+     * stopped command server costs at most this long; whatever arrived by
+     * then is returned and the poll is flagged partial.
+     */
+    void setReplyBudget(int budgetMs) {
+        budget = std::chrono::milliseconds(budgetMs > 0 ? budgetMs : DEFAULT_BUDGET_MS);
+    }
 
-        logger.info("Sending handle-level status inquiry...");
-        auto handleResponses = sendPCFCommand(hCmdQueue, hReplyQueue, replyQName, cmdBuffer, cmdLen);
+    int replyBudgetMs() const { return (int)budget.count(); }
 
-        // Parse handle-level data, grouped by queue name
-        std::map<std::string, std::vector<PCFHandleData>> handleMap;
-        for (const auto& resp : handleResponses) {
-            PCFHandleData h = parseHandleStatusResponse(resp);
-            if (!h.queueName.empty()) {
-                handleMap[h.queueName].push_back(h);
+    // True if the last poll could not reach the command server or missed replies
+    bool lastPollPartial() const { return partial; }
+
+    // Inquiries of the last poll that failed or were cut off by the deadline
+    size_t lastPollIncomplete() const { return incompleteRequests; }
+
+    // True if the last poll reached no command server at all, e.g. over a connection that broke while pooled
+    bool lastPollUnsent() const { return sentRequests == 0; }
+
+    // Poll through another caller-owned session from now on, e.g. after reconnecting
+    void useSession(MQPCFSession& pcfSession) {
+        ownedSession.reset();
+        session = &pcfSession;
+        hConn = pcfSession.connection();
+    }
+
+    /**
+     * Poll the queue manager and pass each output row to onRow(const PCFStatusRow&):
+     * one row per open handle, or a single row with no handle for a queue
+     * nobody has open. Rows are emitted in queue-name order and reference the
+     * parsed replies, which stay valid until the next poll. Returns the number
+     * of rows emitted.
+     */
+    template <typename RowCallback>
+    size_t inquireQueueStatuses(RowCallback&& onRow) {
+        if (!pollQueueStatuses()) return 0;
+        return emitJoinedRows(onRow);
+    }
+
+    /**
+     * Asynchronous poll, driven by a message consumer (see MQAsyncPCFEngine):
+     * startAsyncPoll() puts the inquiries and returns at once, the consumer
+     * hands each message from the reply queue to deliverReply(), and
+     * finishAsyncPoll() parses and joins what arrived, like
+     * inquireQueueStatuses(). deliverReply() may run on another thread, but
+     * never concurrently with the other two.
+     */
+    bool startAsyncPoll() { return startInquiries(); }
+
+    // Route a reply to its inquiry by CorrelId; returns true once every inquiry is answered
+    bool deliverReply(const MQMD& msgDesc, const unsigned char* data, MQLONG dataLen) {
+        PCFRequest* request = findRequest(msgDesc.CorrelId, requests.data(), requests.size());
+        if (!request || request->complete) {
+            logger.warning("Discarding PCF reply that matches no command in flight");
+        } else if (acceptReply(data, dataLen, *request)) {
+            request->responses->push_back(replyPool.keep(data, dataLen));
+        }
+        return asyncPollAnswered();
+    }
+
+    bool asyncPollAnswered() const {
+        for (const auto& request : requests) {
+            if (!request.complete) return false;
+        }
+        return true;
+    }
+
+    // Time by which the poll in progress must be answered
+    std::chrono::steady_clock::time_point pollDeadline() const { return deadline; }
+
+    MQPCFSession& pcfSession() { return *session; }
+
+    template <typename RowCallback>
+    size_t finishAsyncPoll(RowCallback&& onRow) {
+        if (requests.empty()) return 0;  // startAsyncPoll() failed
+        indexCollectedReplies();
+        return emitJoinedRows(onRow);
+    }
+
+    /**
+     * Streaming variant of inquireQueueStatuses(): the queue-level replies are
+     * received first (they are needed to complete any row), then each
+     * handle-level reply is parsed and emitted as soon as it arrives and its
+     * buffer is reused for the next one. Memory is bounded by the number of
+     * queues rather than handles. Handle rows come in reply order, followed
+     * by one row for each queue without handles in queue-name order; the
+     * handle a row references is only valid inside onRow.
+     */
+    template <typename RowCallback>
+    size_t streamQueueStatuses(RowCallback&& onRow) {
+        if (!startInquiries()) return 0;
+
+        auto noop = [](const PCFReply&) {};
+        for (auto& request : requests) {
+            if (request.responses != &handleResponses) {
+                receiveReplies(hReplyQueue, request, true, noop);
             }
         }
-        logger.info("Retrieved " + std::to_string(handleResponses.size()) + " handle entries");
-
-        // === Step 3: Merge - for each queue, emit one row per handle ===
-        for (auto& entry : queueMap) {
-            const std::string& qName = entry.first;
-            PCFQueueData& baseQueue = entry.second;
-
-            auto it = handleMap.find(qName);
-            if (it != handleMap.end() && !it->second.empty()) {
-                // Queue has open handles - create one row per handle
-                for (const auto& h : it->second) {
-                    PCFQueueData row = baseQueue;  // Copy queue-level data
-                    row.connection = h.connection;
-                    row.user = h.user;
-                    row.applicationTag = h.applicationTag;
-                    row.channelName = h.channelName;
-                    row.processId = h.processId;
-                    row.processType = h.processType;
-                    row.role = h.role;
-                    results.push_back(row);
+        logger.info("Collected {} queue-level replies in {} ms", queueResponses.size(), msSincePollStart());
+        logFilterEffect();
+
+        // === Step 2: Index the queues; handles are joined as they arrive ===
+        buildQueueIndex();
+        handleCursor.assign(queueViews.size(), 0);  // Handle count per queue ID
+
+        // === Step 3: Stream one row per handle-level reply ===
+        size_t rows = 0;
+        size_t handles = 0;
+        size_t unmatched = 0;
+        long long firstRowMs = -1;
+        for (auto& request : requests) {
+            if (request.responses != &handleResponses) continue;
+            receiveReplies(hReplyQueue, request, false, [&](const PCFReply& reply) {
+                handles++;
+                PCFHandleView h;
+                if (!parseHandleStatusResponse(reply, h) || h.queueName.empty()) return;
+                auto it = queueIds.find(h.queueName);
+                if (it == queueIds.end()) {
+                    unmatched++;
+                    return;
                 }
-            } else {
-                // No open handles - emit single row with defaults
-                results.push_back(baseQueue);
+                if (firstRowMs < 0) firstRowMs = msSincePollStart();
+                handleCursor[it->second]++;
+                PCFHandleRecord record = internHandle(h);
+                onRow(PCFStatusRow{queueViews[it->second], &record, strings});
+                rows++;
+            });
+        }
+
+        // Queues nobody has open - emit single row with defaults
+        for (uint32_t id = 0; id < (uint32_t)queueViews.size(); id++) {
+            if (handleCursor[id] == 0) {
+                if (firstRowMs < 0) firstRowMs = msSincePollStart();
+                onRow(PCFStatusRow{queueViews[id], nullptr, strings});
+                rows++;
             }
         }
 
-        // Close command queue and delete dynamic reply queue
-        MQCLOSE(hConn, &hCmdQueue, MQCO_NONE, &compCode, &reason);
-        MQCLOSE(hConn, &hReplyQueue, MQCO_DELETE_PURGE, &compCode, &reason);
+        logDroppedHandles(unmatched);
+        checkCompleteness();
+        logger.info("Streamed {} rows from {} handle-level replies, first row after {} ms, done in {} ms",
+                    rows, handles, firstRowMs < 0 ? 0 : firstRowMs, msSincePollStart());
+        finishInquiries();
 
-        logger.info("Final result: " + std::to_string(results.size()) + " rows (queues + handles)");
+        logInternStats();
+        logger.info("Final result: {} rows (queues + handles)", rows);
+        return rows;
+    }
+
+    // Poll and copy out every row. Prefer inquireQueueStatuses() for large queue managers.
+    std::vector<PCFQueueData> inquireAllQueueStatuses() {
+        std::vector<PCFQueueData> results;
+        inquireQueueStatuses([&results](const PCFStatusRow& row) {
+            results.push_back(materializeRow(row));
+        });
         return results;
     }
 };
 
+// Display values of a row, shared by every output sink
+inline std::string_view PCFStatusRow::queueType() const {
+    return MQPCFStatusInquirer::queueTypeName(queue.queueType);
+}
+
+inline std::string_view PCFStatusRow::connection() const {
+    return MQPCFStatusInquirer::orNA(handle ? strings.view(handle->connection) : std::string_view());
+}
+
+inline std::string_view PCFStatusRow::channelName() const {
+    return MQPCFStatusInquirer::orNA(handle ? strings.view(handle->channelName) : std::string_view());
+}
+
+inline std::string_view PCFStatusRow::user() const {
+    return MQPCFStatusInquirer::orNA(handle ? strings.view(handle->user) : std::string_view());
+}
+
+inline std::string_view PCFStatusRow::applicationTag() const {
+    return MQPCFStatusInquirer::orNA(handle ? strings.view(handle->applicationTag) : std::string_view());
+}
+
+inline MQLONG PCFStatusRow::processId() const {
+    return handle ? handle->processId : 0;
+}
+
+inline std::string PCFStatusRow::processType() const {
+    return handle && handle->applType != PCFHandleRecord::NO_APPL_TYPE
+        ? MQPCFStatusInquirer::applTypeName(handle->applType) : "N/A";
+}
+
+inline std::string_view PCFStatusRow::role() const {
+    return handle ? MQPCFStatusInquirer::roleName(handle->openOptions) : "N/A";
+}
+
 #endif // MQ_PCF_STATUS_INQUIRER_H
@@ -0,0 +1,164 @@
+#ifndef MQ_POLL_SCHEDULER_H
+#define MQ_POLL_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <functional>
+#include "mq_log.h"
+
+/**
+ * Poll Scheduler - Fires recurring polls, each on its own interval
+ *
+ * Due times live in a min-heap, so the loop sleeps until the earliest one
+ * whatever the number of targets. Every target keeps a nominal schedule
+ * (start + n * interval) and each firing is moved by a random jitter of up to
+ * jitterFraction * interval, so targets with the same interval do not all
+ * fire at once; the first firing is spread over a whole interval. A target
+ * whose previous poll is still running is not fired again (the slot is
+ * counted as skipped), and slots missed because the process fell behind are
+ * skipped rather than fired in a burst.
+ */
+class MQPollScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct Target {
+        std::string name;
+        std::chrono::milliseconds interval;
+        Clock::time_point nominal;    // Un-jittered due time of the next slot
+        bool busy = false;
+        size_t fired = 0;
+        size_t skippedBusy = 0;
+        size_t skippedLate = 0;
+    };
+
+    struct Due {
+        Clock::time_point at;
+        size_t target;
+        bool operator>(const Due& other) const { return at > other.at; }
+    };
+
+    MQLog& logger;
+    double jitterFraction;
+    std::mt19937 random;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<Target> targets;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> heap;
+
+    std::chrono::milliseconds jitterFor(const Target& target) {
+        long long range = (long long)(target.interval.count() * jitterFraction);
+        if (range <= 0) return std::chrono::milliseconds(0);
+        std::uniform_int_distribution<long long> dist(-range, range);
+        return std::chrono::milliseconds(dist(random));
+    }
+
+    // Queue the target's next slot after the one at `nominal`, skipping slots already in the past
+    void scheduleNext(size_t id, Clock::time_point now) {
+        Target& target = targets[id];
+        target.nominal += target.interval;
+        while (target.nominal + target.interval <= now) {
+            target.nominal += target.interval;
+            target.skippedLate++;
+        }
+        heap.push({target.nominal + jitterFor(target), id});
+    }
+
+public:
+    explicit MQPollScheduler(MQLog& log, double jitter = 0.1)
+        : logger(log), jitterFraction(jitter), random(std::random_device{}()) {}
+
+    // Add a target; returns its ID, which is passed to the dispatch function
+    size_t add(const std::string& name, std::chrono::milliseconds interval) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (interval.count() <= 0) interval = std::chrono::milliseconds(1000);
+        size_t id = targets.size();
+        Target target;
+        target.name = name;
+        target.interval = interval;
+        std::uniform_int_distribution<long long> spread(0, interval.count() - 1);
+        target.nominal = Clock::now() + std::chrono::milliseconds(spread(random));
+        targets.push_back(target);
+        heap.push({target.nominal, id});
+        return id;
+    }
+
+    /**
+     * Fire targets until stop is set. dispatch(id) starts a poll and must
+     * lead to exactly one complete(id) call, from any thread, when the poll
+     * is over. Before returning, waits for the polls still running.
+     * beforeDispatch() runs on the scheduler's thread before each firing
+     * (used to roll output files on time boundaries).
+     */
+    void run(const std::atomic<bool>& stop, const std::function<void(size_t)>& dispatch,
+             const std::function<void()>& beforeDispatch = nullptr) {
+        // Signals cannot notify a condition variable; look at the stop flag this often
+        const auto stopCheck = std::chrono::milliseconds(250);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stop) {
+            auto now = Clock::now();
+            if (heap.empty() || heap.top().at > now) {
+                auto wakeAt = now + stopCheck;
+                if (!heap.empty() && heap.top().at < wakeAt) wakeAt = heap.top().at;
+                idle.wait_until(lock, wakeAt);
+                continue;
+            }
+
+            size_t id = heap.top().target;
+            heap.pop();
+            Target& target = targets[id];
+            scheduleNext(id, now);
+
+            if (target.busy) {
+                target.skippedBusy++;
+                logger.warning("Poll of {} still running, skipping this slot", target.name);
+                continue;
+            }
+            target.busy = true;
+            target.fired++;
+
+            lock.unlock();
+            if (beforeDispatch) beforeDispatch();
+            dispatch(id);
+            lock.lock();
+        }
+
+        idle.wait(lock, [this] {
+            for (const auto& target : targets) {
+                if (target.busy) return false;
+            }
+            return true;
+        });
+    }
+
+    // The poll started for target id is over
+    void complete(size_t id) {
+        std::lock_guard<std::mutex> guard(mutex);
+        targets[id].busy = false;
+        idle.notify_all();
+    }
+
+    const std::string& name(size_t id) const { return targets[id].name; }
+
+    void logStats() {
+        std::lock_guard<std::mutex> guard(mutex);
+        size_t fired = 0, skippedBusy = 0, skippedLate = 0;
+        for (const auto& target : targets) {
+            fired += target.fired;
+            skippedBusy += target.skippedBusy;
+            skippedLate += target.skippedLate;
+        }
+        logger.info("Scheduler: {} poll(s) over {} queue manager(s), {} slot(s) skipped while a poll was running, {} slot(s) missed",
+                    fired, targets.size(), skippedBusy, skippedLate);
+    }
+};
+
+#endif // MQ_POLL_SCHEDULER_H
@@ -44,8 +44,7 @@ public:
         MQOPEN(hConn, &queueDesc, MQOO_INQUIRE, &hQueue, &compCode, &reason);
 
         if (compCode != MQCC_OK) {
-            logger.warning("Could not open queue for inquiry: " + queueName +
-                           " (Reason: " + std::to_string(reason) + ")");
+            logger.warning("Could not open queue for inquiry: {} (Reason: {})", queueName, reason);
             status.queueName = queueName;
             status.status = "Unavailable";
             status.currentDepth = 0;
@@ -0,0 +1,165 @@
+#ifndef MQ_REPLY_BUFFER_POOL_H
+#define MQ_REPLY_BUFFER_POOL_H
+
+#include <cmqc.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+
+/**
+ * A received PCF reply; points into a slab owned by ReplyBufferPool and stays
+ * valid until the pool is reset.
+ */
+struct PCFReply {
+    const unsigned char* data;
+    MQLONG length;
+};
+
+/**
+ * Reply Buffer Pool - Reusable slab storage for PCF reply messages
+ *
+ * Replies are received directly into large slabs that are kept across
+ * replies and across polls; reset() rewinds to the first slab without
+ * freeing anything, so a pool that has seen a poll of a given size serves
+ * the next one without touching the heap. Slabs never move, which keeps
+ * views into earlier replies valid while later ones are received.
+ *
+ * The largest reply seen is remembered per queue manager, so a new pool for
+ * the same queue manager starts with a receive window that avoids a
+ * truncation retry.
+ */
+class ReplyBufferPool {
+private:
+    struct Slab {
+        std::unique_ptr<unsigned char[]> data;
+        size_t capacity;
+    };
+
+    static constexpr size_t DEFAULT_RECEIVE_SIZE = 65536;
+    static constexpr size_t MIN_SLAB_SIZE = 1024 * 1024;
+
+    std::string qmName;
+    std::vector<Slab> slabs;
+    size_t currentSlab = 0;
+    size_t slabUsed = 0;
+    size_t receiveSize;
+    size_t largestLocal = 0;
+
+    // Counters since construction; the per-poll figures are deltas of these
+    size_t allocations = 0;
+    size_t replies = 0;
+    size_t truncationRetries = 0;
+    size_t bytesReceived = 0;
+
+    static std::mutex& registryMutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::map<std::string, size_t>& largestByQM() {
+        static std::map<std::string, size_t> sizes;
+        return sizes;
+    }
+
+    void addSlab(size_t minCapacity) {
+        size_t capacity = std::max(MIN_SLAB_SIZE, minCapacity * 4);
+        slabs.push_back(Slab{std::unique_ptr<unsigned char[]>(new unsigned char[capacity]), capacity});
+        allocations++;
+    }
+
+public:
+    explicit ReplyBufferPool(const std::string& qm)
+        : qmName(qm), receiveSize(std::max(DEFAULT_RECEIVE_SIZE, largestSeen(qm))) {}
+
+    ReplyBufferPool(const ReplyBufferPool&) = delete;
+    ReplyBufferPool& operator=(const ReplyBufferPool&) = delete;
+
+    // Largest reply recorded for a queue manager by any pool (0 if none yet)
+    static size_t largestSeen(const std::string& qm) {
+        std::lock_guard<std::mutex> guard(registryMutex());
+        auto it = largestByQM().find(qm);
+        return it != largestByQM().end() ? it->second : 0;
+    }
+
+    // Release every reply; slabs are kept for the next poll
+    void reset() {
+        currentSlab = 0;
+        slabUsed = 0;
+    }
+
+    /**
+     * Receive window for the next MQGET: at least the expected reply size,
+     * moving to the next slab (allocating one only if none is left) when the
+     * current slab cannot hold that much.
+     */
+    unsigned char* window(MQLONG& windowLength) {
+        if (slabs.empty()) addSlab(receiveSize);
+
+        while (slabs[currentSlab].capacity - slabUsed < receiveSize) {
+            currentSlab++;
+            slabUsed = 0;
+            if (currentSlab == slabs.size()) addSlab(receiveSize);
+        }
+
+        size_t available = slabs[currentSlab].capacity - slabUsed;
+        windowLength = (MQLONG)std::min(available, (size_t)0x7FFFFFFF);
+        return slabs[currentSlab].data.get() + slabUsed;
+    }
+
+    // MQGET failed with MQRC_TRUNCATED_MSG_FAILED; size the next window for it
+    void growForTruncated(MQLONG actualLength) {
+        truncationRetries++;
+        receiveSize = std::max(receiveSize, (size_t)actualLength);
+    }
+
+    // Keep the message just received into the current window
+    PCFReply commit(MQLONG length) {
+        PCFReply reply = borrow(length);
+        // Keep the next reply 4-byte aligned for the PCF structures
+        slabUsed = std::min(slabs[currentSlab].capacity, slabUsed + (((size_t)length + 3) & ~(size_t)3));
+        return reply;
+    }
+
+    // Keep a copy of a message received into another buffer (an MQCB callback's)
+    PCFReply keep(const unsigned char* data, MQLONG length) {
+        if ((size_t)length > receiveSize) receiveSize = length;
+        MQLONG windowLength = 0;
+        memcpy(window(windowLength), data, length);
+        return commit(length);
+    }
+
+    // Use the message just received without keeping it; the next window reuses its space
+    PCFReply borrow(MQLONG length) {
+        PCFReply reply{slabs[currentSlab].data.get() + slabUsed, length};
+        replies++;
+        bytesReceived += length;
+
+        if ((size_t)length > receiveSize) receiveSize = length;
+        if ((size_t)length > largestLocal) {
+            // Only a new maximum touches the shared registry
+            largestLocal = length;
+            std::lock_guard<std::mutex> guard(registryMutex());
+            size_t& largest = largestByQM()[qmName];
+            if (largestLocal > largest) largest = largestLocal;
+        }
+        return reply;
+    }
+
+    size_t allocationCount() const { return allocations; }
+    size_t replyCount() const { return replies; }
+    size_t truncationRetryCount() const { return truncationRetries; }
+    size_t bytesReceivedCount() const { return bytesReceived; }
+    size_t receiveWindowSize() const { return receiveSize; }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& slab : slabs) total += slab.capacity;
+        return total;
+    }
+};
+
+#endif // MQ_REPLY_BUFFER_POOL_H
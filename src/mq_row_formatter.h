@@ -0,0 +1,225 @@
+#ifndef MQ_ROW_FORMATTER_H
+#define MQ_ROW_FORMATTER_H
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "mq_pcf_status_inquirer.h"
+
+/**
+ * Row Formatter - Text of status rows for the CSV report and the log table
+ *
+ * Rows are appended to a string the caller keeps and reuses, so once it has
+ * grown to the size of a report no row allocates. Each row reserves room for
+ * its longest possible text once and is then written through a plain
+ * pointer: fields are memcpy'd, numbers written with std::to_chars and table
+ * padding filled with memset, to column widths fixed below. CSV fields are
+ * quoted (RFC 4180) only if a scan finds a comma, quote or line break in
+ * them, which real names almost never contain.
+ */
+class RowFormatter {
+private:
+    static constexpr size_t MAX_NUMBER = 20;    // Digits and sign of a long long
+
+    // True if any byte of word equals byte (pattern holds byte in every position)
+    static bool hasByte(uint64_t word, uint64_t pattern) {
+        uint64_t x = word ^ pattern;
+        return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
+    }
+
+    // Characters that force a CSV field into quotes, looked for 8 bytes at a time
+    static bool needsQuoting(std::string_view field) {
+        const uint64_t ones = 0x0101010101010101ULL;
+        const char* p = field.data();
+        size_t left = field.size();
+        for (; left >= 8; p += 8, left -= 8) {
+            uint64_t word;
+            memcpy(&word, p, 8);
+            if (hasByte(word, ones * ',') || hasByte(word, ones * '"') ||
+                hasByte(word, ones * '\n') || hasByte(word, ones * '\r')) {
+                return true;
+            }
+        }
+        for (; left > 0; p++, left--) {
+            if (*p == ',' || *p == '"' || *p == '\n' || *p == '\r') return true;
+        }
+        return false;
+    }
+
+    static char* put(char* p, std::string_view text) {
+        memcpy(p, text.data(), text.size());
+        return p + text.size();
+    }
+
+    static char* putNumber(char* p, long long value) {
+        return std::to_chars(p, p + MAX_NUMBER, value).ptr;
+    }
+
+    // At most 2 * field.size() + 2 bytes
+    static char* putCSVField(char* p, std::string_view field) {
+        if (!needsQuoting(field)) return put(p, field);
+        *p++ = '"';
+        for (char c : field) {
+            if (c == '"') *p++ = '"';
+            *p++ = c;
+        }
+        *p++ = '"';
+        return p;
+    }
+
+    // At most max(text.size(), width) bytes; wider values push the next columns right
+    static char* putPadded(char* p, std::string_view text, size_t width, bool rightAlign = false) {
+        size_t padding = text.size() < width ? width - text.size() : 0;
+        if (rightAlign) {
+            memset(p, ' ', padding);
+            p += padding;
+        }
+        p = put(p, text);
+        if (!rightAlign) {
+            memset(p, ' ', padding);
+            p += padding;
+        }
+        return p;
+    }
+
+    static char* putPadded(char* p, long long value, size_t width) {
+        char digits[MAX_NUMBER];
+        char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return putPadded(p, std::string_view(digits, end - digits), width, true);
+    }
+
+    // Grow out by bound bytes and return where the row starts; finish() trims the rest
+    static char* reserve(std::string& out, size_t bound) {
+        size_t used = out.size();
+        out.resize(used + bound);
+        return &out[used];
+    }
+
+    static void finish(std::string& out, const char* end) {
+        out.resize(end - out.data());
+    }
+
+public:
+    static void appendNumber(std::string& out, long long value) {
+        finish(out, putNumber(reserve(out, MAX_NUMBER), value));
+    }
+
+    // A CSV field, quoted with inner quotes doubled when it contains , " CR or LF
+    static void appendCSVField(std::string& out, std::string_view field) {
+        finish(out, putCSVField(reserve(out, 2 * field.size() + 2), field));
+    }
+
+    static const char* csvHeader() {
+        return "Timestamp,Queue_Manager,Queue_Name,Queue_Type,Current_Depth,Input_Count,Output_Count,"
+               "Connection,Channel,User,Process_ID,Application_Tag,Process_Type,Role\n";
+    }
+
+    // One CSV line in csvHeader() order
+    static void appendCSVRow(std::string& out, std::string_view timestamp, std::string_view qmName,
+                             const PCFStatusRow& r) {
+        std::string_view queueName = r.queue.queueName;
+        std::string_view queueType = r.queueType();
+        std::string_view connection = r.connection();
+        std::string_view channel = r.channelName();
+        std::string_view user = r.user();
+        std::string_view applicationTag = r.applicationTag();
+        std::string processType = r.processType();
+        std::string_view role = r.role();
+
+        size_t bound = timestamp.size() + queueType.size() + processType.size() + role.size() +
+                       2 * (qmName.size() + queueName.size() + connection.size() + channel.size() +
+                            user.size() + applicationTag.size() + 6) +
+                       4 * MAX_NUMBER + 14;
+        char* p = reserve(out, bound);
+        p = put(p, timestamp);
+        *p++ = ',';
+        p = putCSVField(p, qmName);
+        *p++ = ',';
+        p = putCSVField(p, queueName);
+        *p++ = ',';
+        p = put(p, queueType);
+        *p++ = ',';
+        p = putNumber(p, r.queue.currentDepth);
+        *p++ = ',';
+        p = putNumber(p, r.queue.openInputCount);
+        *p++ = ',';
+        p = putNumber(p, r.queue.openOutputCount);
+        *p++ = ',';
+        p = putCSVField(p, connection);
+        *p++ = ',';
+        p = putCSVField(p, channel);
+        *p++ = ',';
+        p = putCSVField(p, user);
+        *p++ = ',';
+        p = putNumber(p, r.processId());
+        *p++ = ',';
+        p = putCSVField(p, applicationTag);
+        *p++ = ',';
+        p = put(p, processType);
+        *p++ = ',';
+        p = put(p, role);
+        *p++ = '\n';
+        finish(out, p);
+    }
+
+    static const char* tableHeader() {
+        return "Queue Name                         | Type    | Depth | Input | Output | Connection       | Channel          | User         | PID   | AppTag                    | Process_Type | Role";
+    }
+
+    static const char* tableRule() {
+        return "--------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------";
+    }
+
+    // appendTableRow() as a log format, for binary logs (see appendTableRecord())
+    static const char* tableRowFormat() {
+        return "{:35}| {:8}| {:>5} | {:>5} | {:>6} | {:17}| {:17}| {:13}| {:>5} | {:26}| {:13}| {}";
+    }
+
+    // One line of the log table, without the line break
+    static void appendTableRow(std::string& out, const PCFStatusRow& r) {
+        std::string_view queueName = r.queue.queueName;
+        std::string_view queueType = r.queueType();
+        std::string_view connection = r.connection();
+        std::string_view channel = r.channelName();
+        std::string_view user = r.user();
+        std::string_view applicationTag = r.applicationTag();
+        std::string processType = r.processType();
+        std::string_view role = r.role();
+
+        // Widths plus separators, or the values when they are wider
+        size_t bound = std::max<size_t>(queueName.size(), 35) + std::max<size_t>(queueType.size(), 8) +
+                       std::max<size_t>(connection.size(), 17) + std::max<size_t>(channel.size(), 17) +
+                       std::max<size_t>(user.size(), 13) + std::max<size_t>(applicationTag.size(), 26) +
+                       std::max<size_t>(processType.size(), 13) + role.size() + 4 * MAX_NUMBER + 33;
+        char* p = reserve(out, bound);
+        p = putPadded(p, queueName, 35);
+        p = put(p, "| ");
+        p = putPadded(p, queueType, 8);
+        p = put(p, "| ");
+        p = putPadded(p, r.queue.currentDepth, 5);
+        p = put(p, " | ");
+        p = putPadded(p, r.queue.openInputCount, 5);
+        p = put(p, " | ");
+        p = putPadded(p, r.queue.openOutputCount, 6);
+        p = put(p, " | ");
+        p = putPadded(p, connection, 17);
+        p = put(p, "| ");
+        p = putPadded(p, channel, 17);
+        p = put(p, "| ");
+        p = putPadded(p, user, 13);
+        p = put(p, "| ");
+        p = putPadded(p, r.processId(), 5);
+        p = put(p, " | ");
+        p = putPadded(p, applicationTag, 26);
+        p = put(p, "| ");
+        p = putPadded(p, processType, 13);
+        p = put(p, "| ");
+        p = put(p, role);
+        finish(out, p);
+    }
+};
+
+#endif // MQ_ROW_FORMATTER_H
@@ -0,0 +1,165 @@
+#ifndef MQ_ROW_SINK_H
+#define MQ_ROW_SINK_H
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include "mq_log.h"
+#include "mq_pcf_status_inquirer.h"
+#include "mq_row_formatter.h"
+#include "mq_csv_file_writer.h"
+
+/**
+ * Row Sinks - Output destinations for queue status rows
+ *
+ * A sink receives each PCFStatusRow as soon as the inquirer produces it and
+ * formats it straight from the reply views, then gets finish() once the poll
+ * is over. Sinks keep no rows, so their memory does not grow with the
+ * number of handles.
+ */
+class PCFRowSink {
+public:
+    virtual ~PCFRowSink() = default;
+
+    virtual void row(const PCFStatusRow& row) = 0;
+
+    // Called once after the last row of a poll with the number of rows emitted
+    virtual void finish(size_t rowCount) = 0;
+};
+
+/**
+ * Writes the QUEUE STATUS REPORT table to the log. Lines are collected and
+ * logged as blocks of up to BLOCK_SIZE (64 KiB) plus one row, the last at
+ * finish(). No other thread's line lands inside a block, so a report that
+ * fits in one block is logged whole. A longer report (a queue manager with
+ * many handles) may have other polls' lines between its blocks; it is not
+ * held whole so that memory does not grow with the handle count. For a
+ * binary log, rows are collected as records of the table row format and
+ * their values, which the log pads only when the file is decoded.
+ */
+class LogTableSink : public PCFRowSink {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    MQLog& logger;
+    std::string qmName;
+    bool headerWritten = false;
+    std::string block;      // Text lines, or binary log records
+
+    // Fixed lines of the table
+    void appendLines(const std::string& lines) {
+        if (logger.binaryFormat()) {
+            MQLog::appendLines(block, lines);
+        } else {
+            block.append(lines);
+        }
+    }
+
+    void logBlock() {
+        if (logger.binaryFormat()) {
+            logger.logRecords(block);
+        } else {
+            logger.logBlock(block);
+            block.clear();
+        }
+    }
+
+    void writeHeader() {
+        std::string header = "\n========================================\n";
+        header.append("QUEUE STATUS REPORT - ").append(qmName).append("\n");
+        header.append("========================================\n\n");
+        header.append(RowFormatter::tableHeader()).append("\n");
+        header.append(RowFormatter::tableRule()).append("\n");
+        appendLines(header);
+        headerWritten = true;
+    }
+
+public:
+    LogTableSink(MQLog& log, const std::string& qm) : logger(log), qmName(qm) {}
+
+    void row(const PCFStatusRow& r) override {
+        if (!headerWritten) writeHeader();
+        if (logger.binaryFormat()) {
+            MQLog::appendRecord(block, RowFormatter::tableRowFormat(), r.queue.queueName, r.queueType(),
+                                r.queue.currentDepth, r.queue.openInputCount, r.queue.openOutputCount,
+                                r.connection(), r.channelName(), r.user(), r.processId(),
+                                r.applicationTag(), r.processType(), r.role());
+        } else {
+            RowFormatter::appendTableRow(block, r);
+            block += '\n';
+        }
+        if (block.size() >= BLOCK_SIZE) logBlock();
+    }
+
+    void finish(size_t rowCount) override {
+        if (rowCount == 0) {
+            logger.warning("No queues returned from PCF for {}", qmName);
+            return;
+        }
+        std::string footer = RowFormatter::tableRule();
+        footer.append("\nTotal: ");
+        RowFormatter::appendNumber(footer, (long long)rowCount);
+        footer.append(" rows\n\n");
+        appendLines(footer);
+        logBlock();
+    }
+};
+
+/**
+ * Formats rows for the CSV report into a buffer of its own and hands each
+ * full buffer (and the rest at finish()) to the CSVFileWriter, so a poll
+ * never waits for the file or for other polls' rows, and never holds more
+ * than one buffer of CSV in memory.
+ */
+class CSVRowSink : public PCFRowSink {
+private:
+    MQLog& logger;
+    CSVFileWriter& writer;
+    std::string csvPath;
+    std::string qmName;
+    std::string timestamp;
+    std::string pending;
+
+    void handOver() {
+        if (pending.empty()) return;
+        writer.submit(csvPath, std::move(pending));
+        pending = writer.takeBuffer();
+    }
+
+public:
+    static const char* header() {
+        return RowFormatter::csvHeader();
+    }
+
+    CSVRowSink(MQLog& log, CSVFileWriter& fileWriter, const std::string& path, const std::string& qm)
+        : logger(log), writer(fileWriter), csvPath(path), qmName(qm), timestamp(formatTime(time(0))) {
+        pending = writer.takeBuffer();
+    }
+
+    static std::string formatTime(time_t when) {
+        struct tm timeinfo;
+#ifdef _WIN32
+        localtime_s(&timeinfo, &when);
+#else
+        localtime_r(&when, &timeinfo);
+#endif
+        std::ostringstream timestampOss;
+        timestampOss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
+        return timestampOss.str();
+    }
+
+    void row(const PCFStatusRow& r) override {
+        RowFormatter::appendCSVRow(pending, timestamp, qmName, r);
+        if (pending.size() >= CSVFileWriter::BUFFER_SIZE) handOver();
+    }
+
+    void finish(size_t rowCount) override {
+        if (!pending.empty()) writer.submit(csvPath, std::move(pending));
+        if (rowCount > 0) {
+            logger.info("CSV data appended to: {}", csvPath);
+        }
+    }
+};
+
+#endif // MQ_ROW_SINK_H
@@ -0,0 +1,757 @@
+#ifndef MQ_SNAPSHOT_FILE_H
+#define MQ_SNAPSHOT_FILE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include "mq_log.h"
+#include "mq_status_snapshot.h"
+
+/**
+ * Snapshot File - Binary columnar copy of status snapshots
+ *
+ * Layout (little-endian, every section 8-byte aligned):
+ *
+ *   SnapshotFileHeader
+ *   block*          one per poll: "MQSB" SnapshotBlockHeader, a column
+ *                   directory (SnapshotColumnInfo per column) and the columns
+ *   index block     "MQSI" header followed by SnapshotIndexEntry per block,
+ *                   sorted by queue manager then time
+ *   SnapshotFileTrailer   offset of the index block
+ *
+ * Columns are the StatusSnapshot columns as fixed-width arrays (one value per
+ * row); names are IDs into the block's string dictionary, stored as an
+ * offset column plus a blob. The directory names each column and its type,
+ * so readers find a column without knowing the writer's order and new
+ * columns can be added. A reader maps the file and uses the arrays in place.
+ *
+ * The index and trailer are written when the file is closed. A file whose
+ * writer did not close it (crash) has no trailer; blocks can still be found
+ * by following each block's size (and skipping the index and trailer left by
+ * an earlier close), which is what SnapshotFileReader does then.
+ */
+
+enum SnapshotColumnId : uint16_t {
+    SNAPSHOT_COL_QUEUE_NAME = 1,
+    SNAPSHOT_COL_QUEUE_TYPE = 2,
+    SNAPSHOT_COL_CURRENT_DEPTH = 3,
+    SNAPSHOT_COL_OPEN_INPUT = 4,
+    SNAPSHOT_COL_OPEN_OUTPUT = 5,
+    SNAPSHOT_COL_HANDLE_FLAGS = 6,
+    SNAPSHOT_COL_CONNECTION = 7,
+    SNAPSHOT_COL_USER = 8,
+    SNAPSHOT_COL_APPLICATION_TAG = 9,
+    SNAPSHOT_COL_CHANNEL = 10,
+    SNAPSHOT_COL_PROCESS_ID = 11,
+    SNAPSHOT_COL_APPL_TYPE = 12,
+    SNAPSHOT_COL_STRING_OFFSETS = 100,   // uint32 per string + 1, into STRING_DATA
+    SNAPSHOT_COL_STRING_DATA = 101       // Bytes of every dictionary string
+};
+
+enum SnapshotColumnType : uint8_t {
+    SNAPSHOT_TYPE_U8 = 1,
+    SNAPSHOT_TYPE_U32 = 2,
+    SNAPSHOT_TYPE_I32 = 3,
+    SNAPSHOT_TYPE_BYTES = 4
+};
+
+enum SnapshotBlockFlags : uint32_t {
+    SNAPSHOT_BLOCK_PARTIAL = 1     // The poll missed replies
+};
+
+#pragma pack(push, 1)
+struct SnapshotFileHeader {
+    char magic[8];              // "MQSNAP\0\1"
+    uint32_t version;
+    uint32_t headerBytes;
+    int64_t createdAt;
+    uint64_t reserved;
+};
+
+struct SnapshotBlockHeader {
+    char magic[4];              // "MQSB" (snapshot) or "MQSI" (index)
+    uint32_t headerBytes;
+    uint64_t blockBytes;        // Whole block, header included
+    int64_t takenAt;
+    uint32_t rowCount;          // Rows, or entries of an index block
+    uint32_t stringCount;
+    uint32_t columnCount;
+    uint32_t flags;             // SnapshotBlockFlags
+    uint32_t queueManager;      // String ID of the queue manager name
+    uint32_t reserved;
+};
+
+struct SnapshotColumnInfo {
+    uint16_t id;                // SnapshotColumnId
+    uint8_t type;               // SnapshotColumnType
+    uint8_t width;              // Bytes per value (1 for BYTES)
+    uint32_t count;             // Values
+    uint64_t offset;            // From the start of the block
+};
+
+struct SnapshotIndexEntry {
+    uint64_t offset;            // Of the block in the file
+    int64_t takenAt;
+    uint32_t rowCount;
+    uint32_t flags;
+    char queueManager[48];      // MQ_Q_MGR_NAME_LENGTH, NUL padded
+};
+
+struct SnapshotFileTrailer {
+    uint64_t indexOffset;
+    uint64_t blockCount;
+    char magic[8];              // "MQSNAPIX"
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SnapshotFileHeader) == 32, "snapshot file header layout");
+static_assert(sizeof(SnapshotBlockHeader) == 48, "snapshot block header layout");
+static_assert(sizeof(SnapshotColumnInfo) == 16, "snapshot column info layout");
+static_assert(sizeof(SnapshotIndexEntry) == 72, "snapshot index entry layout");
+static_assert(sizeof(SnapshotFileTrailer) == 24, "snapshot trailer layout");
+
+namespace SnapshotFormat {
+    constexpr char FILE_MAGIC[8] = {'M', 'Q', 'S', 'N', 'A', 'P', '\0', '\1'};
+    constexpr char BLOCK_MAGIC[4] = {'M', 'Q', 'S', 'B'};
+    constexpr char INDEX_MAGIC[4] = {'M', 'Q', 'S', 'I'};
+    constexpr char TRAILER_MAGIC[8] = {'M', 'Q', 'S', 'N', 'A', 'P', 'I', 'X'};
+    constexpr uint32_t VERSION = 1;
+
+    inline size_t align8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+    // Index order: queue manager name, then time
+    inline bool entryLess(const SnapshotIndexEntry& a, const SnapshotIndexEntry& b) {
+        int byName = strncmp(a.queueManager, b.queueManager, sizeof(a.queueManager));
+        return byName != 0 ? byName < 0 : a.takenAt < b.takenAt;
+    }
+}
+
+/**
+ * One snapshot block of a mapped file. Column accessors return the arrays in
+ * place (nullptr if the block has no such column). A view is only made of a
+ * block that passed check(), so a damaged file cannot send it past the end
+ * of the mapping.
+ */
+class SnapshotBlockView {
+private:
+    const unsigned char* base = nullptr;
+    const SnapshotBlockHeader* header = nullptr;
+    const SnapshotColumnInfo* directory = nullptr;
+    const uint32_t* stringOffsets = nullptr;
+    const char* stringData = nullptr;
+
+    const SnapshotColumnInfo* find(uint16_t id) const {
+        for (uint32_t i = 0; i < header->columnCount; i++) {
+            if (directory[i].id == id) return &directory[i];
+        }
+        return nullptr;
+    }
+
+    // A column with a value for every row
+    template <typename T>
+    const T* rowColumn(uint16_t id) const {
+        const SnapshotColumnInfo* info = find(id);
+        if (!info || info->width != sizeof(T) || info->count < header->rowCount) return nullptr;
+        return (const T*)(base + info->offset);
+    }
+
+public:
+    SnapshotBlockView() = default;
+
+    /**
+     * True if the block at block, with available bytes of the file from
+     * there on, holds its header, directory, columns and string offsets
+     * within its own blockBytes.
+     */
+    static bool check(const unsigned char* block, size_t available) {
+        if (available < sizeof(SnapshotBlockHeader)) return false;
+        const SnapshotBlockHeader* h = (const SnapshotBlockHeader*)block;
+        uint64_t bytes = h->blockBytes;
+        if (bytes < sizeof(SnapshotBlockHeader) || bytes > available) return false;
+        if (h->headerBytes < sizeof(SnapshotBlockHeader) || h->headerBytes > bytes ||
+            (uint64_t)h->columnCount * sizeof(SnapshotColumnInfo) > bytes - h->headerBytes) {
+            return false;
+        }
+
+        const SnapshotColumnInfo* columns = (const SnapshotColumnInfo*)(block + h->headerBytes);
+        const SnapshotColumnInfo* offsets = nullptr;
+        const SnapshotColumnInfo* data = nullptr;
+        for (uint32_t i = 0; i < h->columnCount; i++) {
+            const SnapshotColumnInfo& info = columns[i];
+            if (info.width == 0 || info.offset > bytes || (uint64_t)info.count * info.width > bytes - info.offset) {
+                return false;
+            }
+            if (info.id == SNAPSHOT_COL_STRING_OFFSETS && !offsets) offsets = &info;
+            if (info.id == SNAPSHOT_COL_STRING_DATA && !data) data = &info;
+        }
+
+        if (h->stringCount == 0) return true;
+        if (!offsets || !data || offsets->width != sizeof(uint32_t) ||
+            offsets->count < (uint64_t)h->stringCount + 1) {
+            return false;
+        }
+        const uint32_t* starts = (const uint32_t*)(block + offsets->offset);
+        for (uint32_t i = 0; i < h->stringCount; i++) {
+            if (starts[i] > starts[i + 1]) return false;
+        }
+        return starts[h->stringCount] <= data->count;
+    }
+
+    explicit SnapshotBlockView(const unsigned char* block)
+        : base(block), header((const SnapshotBlockHeader*)block),
+          directory((const SnapshotColumnInfo*)(block + header->headerBytes)) {
+        const SnapshotColumnInfo* offsets = find(SNAPSHOT_COL_STRING_OFFSETS);
+        const SnapshotColumnInfo* data = find(SNAPSHOT_COL_STRING_DATA);
+        if (offsets) stringOffsets = (const uint32_t*)(base + offsets->offset);
+        if (data) stringData = (const char*)(base + data->offset);
+    }
+
+    bool valid() const { return header != nullptr; }
+    size_t rows() const { return header->rowCount; }
+    time_t takenAt() const { return (time_t)header->takenAt; }
+    bool partial() const { return (header->flags & SNAPSHOT_BLOCK_PARTIAL) != 0; }
+    uint32_t stringCount() const { return header->stringCount; }
+    std::string_view queueManager() const { return text(header->queueManager); }
+
+    std::string_view text(uint32_t id) const {
+        if (!stringOffsets || id >= header->stringCount) return std::string_view();
+        return std::string_view(stringData + stringOffsets[id], stringOffsets[id + 1] - stringOffsets[id]);
+    }
+
+    template <typename T>
+    const T* column(uint16_t id) const {
+        const SnapshotColumnInfo* info = find(id);
+        if (!info || info->width != sizeof(T)) return nullptr;
+        return (const T*)(base + info->offset);
+    }
+
+    /**
+     * Hand every row to fn(const PCFStatusRow&), as StatusSnapshot::forEachRow
+     * does, so the output sinks can format blocks read from a file. Returns
+     * false, before or after some rows, if the block lacks one of the
+     * columns or a row names a string the block does not have.
+     */
+    template <typename RowCallback>
+    bool forEachRow(RowCallback&& fn) const {
+        const uint32_t* queueName = rowColumn<uint32_t>(SNAPSHOT_COL_QUEUE_NAME);
+        const uint8_t* queueType = rowColumn<uint8_t>(SNAPSHOT_COL_QUEUE_TYPE);
+        const int32_t* currentDepth = rowColumn<int32_t>(SNAPSHOT_COL_CURRENT_DEPTH);
+        const int32_t* openInput = rowColumn<int32_t>(SNAPSHOT_COL_OPEN_INPUT);
+        const int32_t* openOutput = rowColumn<int32_t>(SNAPSHOT_COL_OPEN_OUTPUT);
+        const uint8_t* handleFlags = rowColumn<uint8_t>(SNAPSHOT_COL_HANDLE_FLAGS);
+        const uint32_t* connection = rowColumn<uint32_t>(SNAPSHOT_COL_CONNECTION);
+        const uint32_t* user = rowColumn<uint32_t>(SNAPSHOT_COL_USER);
+        const uint32_t* applicationTag = rowColumn<uint32_t>(SNAPSHOT_COL_APPLICATION_TAG);
+        const uint32_t* channelName = rowColumn<uint32_t>(SNAPSHOT_COL_CHANNEL);
+        const int32_t* processId = rowColumn<int32_t>(SNAPSHOT_COL_PROCESS_ID);
+        const int32_t* applType = rowColumn<int32_t>(SNAPSHOT_COL_APPL_TYPE);
+        if (!queueName || !queueType || !currentDepth || !openInput || !openOutput || !handleFlags ||
+            !connection || !user || !applicationTag || !channelName || !processId || !applType) {
+            return false;
+        }
+
+        // Distinct strings in ID order, so interning gives back the file's IDs
+        StringInterner strings;
+        for (uint32_t id = 1; id < stringCount(); id++) strings.intern(text(id));
+        uint32_t known = (uint32_t)strings.size();
+        if (stringCount() > 0 && known != stringCount()) return false;     // Repeated strings: IDs would not match
+
+        for (size_t i = 0; i < rows(); i++) {
+            if (queueName[i] >= known) return false;
+            PCFQueueView queue;
+            queue.queueName = strings.view(queueName[i]);
+            queue.queueType = queueType[i];
+            queue.currentDepth = currentDepth[i];
+            queue.openInputCount = openInput[i];
+            queue.openOutputCount = openOutput[i];
+
+            if (!(handleFlags[i] & SNAPSHOT_HAS_HANDLE)) {
+                fn(PCFStatusRow{queue, nullptr, strings});
+                continue;
+            }
+            if (connection[i] >= known || user[i] >= known || applicationTag[i] >= known ||
+                channelName[i] >= known) {
+                return false;
+            }
+            PCFHandleRecord handle;
+            handle.connection = connection[i];
+            handle.user = user[i];
+            handle.applicationTag = applicationTag[i];
+            handle.channelName = channelName[i];
+            handle.applType = applType[i];
+            handle.processId = processId[i];
+            handle.openOptions = ((handleFlags[i] & SNAPSHOT_READER) ? MQOO_INPUT_AS_Q_DEF : 0) |
+                                 ((handleFlags[i] & SNAPSHOT_WRITER) ? MQOO_OUTPUT : 0);
+            fn(PCFStatusRow{queue, &handle, strings});
+        }
+        return true;
+    }
+};
+
+/**
+ * Snapshot File Reader - Maps a snapshot file and lists its blocks
+ */
+class SnapshotFileReader {
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    std::vector<SnapshotIndexEntry> entries;
+    bool indexed = false;
+    std::string errorText;
+
+    bool fail(const std::string& message) {
+        errorText = message;
+        close();
+        return false;
+    }
+
+    // Use the index the writer left, if the file ends with a valid trailer
+    bool readIndex() {
+        if (size < sizeof(SnapshotFileHeader) + sizeof(SnapshotFileTrailer)) return false;
+        const SnapshotFileTrailer* trailer = (const SnapshotFileTrailer*)(data + size - sizeof(SnapshotFileTrailer));
+        if (memcmp(trailer->magic, SnapshotFormat::TRAILER_MAGIC, 8) != 0) return false;
+        if (trailer->indexOffset > size - sizeof(SnapshotFileTrailer) - sizeof(SnapshotBlockHeader)) return false;
+
+        const SnapshotBlockHeader* index = (const SnapshotBlockHeader*)(data + trailer->indexOffset);
+        if (memcmp(index->magic, SnapshotFormat::INDEX_MAGIC, 4) != 0) return false;
+        uint64_t available = size - trailer->indexOffset;
+        if (index->headerBytes < sizeof(SnapshotBlockHeader) || index->headerBytes > available ||
+            (uint64_t)index->rowCount * sizeof(SnapshotIndexEntry) > available - index->headerBytes) {
+            return false;
+        }
+        const SnapshotIndexEntry* first = (const SnapshotIndexEntry*)((const unsigned char*)index + index->headerBytes);
+        entries.assign(first, first + index->rowCount);
+        return true;
+    }
+
+    // No trailer: walk the blocks by their sizes
+    void scanBlocks() {
+        size_t offset = sizeof(SnapshotFileHeader);
+        while (offset + sizeof(SnapshotBlockHeader) <= size) {
+            const SnapshotBlockHeader* header = (const SnapshotBlockHeader*)(data + offset);
+            if (header->blockBytes < sizeof(SnapshotBlockHeader) || header->blockBytes > size - offset) break;
+            if (memcmp(header->magic, SnapshotFormat::BLOCK_MAGIC, 4) == 0) {
+                if (!SnapshotBlockView::check(data + offset, size - offset)) break;
+                SnapshotBlockView view(data + offset);
+                SnapshotIndexEntry entry = {};
+                entry.offset = offset;
+                entry.takenAt = header->takenAt;
+                entry.rowCount = header->rowCount;
+                entry.flags = header->flags;
+                std::string_view qm = view.queueManager();
+                memcpy(entry.queueManager, qm.data(), std::min(qm.size(), sizeof(entry.queueManager) - 1));
+                entries.push_back(entry);
+            } else if (memcmp(header->magic, SnapshotFormat::INDEX_MAGIC, 4) == 0) {
+                // A file closed and then appended to has an old index and trailer between its blocks
+                offset += header->blockBytes;
+                const SnapshotFileTrailer* trailer = (const SnapshotFileTrailer*)(data + offset);
+                if (offset + sizeof(SnapshotFileTrailer) <= size &&
+                    memcmp(trailer->magic, SnapshotFormat::TRAILER_MAGIC, 8) == 0) {
+                    offset += sizeof(SnapshotFileTrailer);
+                }
+                continue;
+            } else {
+                break;
+            }
+            offset += header->blockBytes;
+        }
+        std::stable_sort(entries.begin(), entries.end(), SnapshotFormat::entryLess);
+    }
+
+public:
+    SnapshotFileReader() = default;
+    ~SnapshotFileReader() { close(); }
+
+    SnapshotFileReader(const SnapshotFileReader&) = delete;
+    SnapshotFileReader& operator=(const SnapshotFileReader&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        entries.clear();
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) return fail("cannot open " + path);
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(fileHandle, &fileSize);
+        size = (size_t)fileSize.QuadPart;
+        if (size < sizeof(SnapshotFileHeader)) return fail(path + " is not a snapshot file");
+        mapping = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return fail("cannot map " + path);
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data) return fail("cannot map " + path);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return fail("cannot open " + path);
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(SnapshotFileHeader)) {
+            ::close(fd);
+            return fail(path + " is not a snapshot file");
+        }
+        size = (size_t)info.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return fail("cannot map " + path);
+        data = (const unsigned char*)mapped;
+#endif
+        const SnapshotFileHeader* header = (const SnapshotFileHeader*)data;
+        if (memcmp(header->magic, SnapshotFormat::FILE_MAGIC, 8) != 0) return fail(path + " is not a snapshot file");
+        if (header->version > SnapshotFormat::VERSION) {
+            return fail(path + " has format version " + std::to_string(header->version));
+        }
+
+        indexed = readIndex();
+        if (!indexed) scanBlocks();
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+        mapping = nullptr;
+        fileHandle = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap((void*)data, size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const std::string& error() const { return errorText; }
+
+    // False if the writer did not close the file and the blocks were found by scanning
+    bool hasIndex() const { return indexed; }
+
+    // Every block, sorted by queue manager then time
+    const std::vector<SnapshotIndexEntry>& index() const { return entries; }
+
+    // The index entries of one queue manager, oldest first
+    std::pair<const SnapshotIndexEntry*, const SnapshotIndexEntry*> find(const std::string& queueManager) const {
+        SnapshotIndexEntry key = {};
+        memcpy(key.queueManager, queueManager.data(), std::min(queueManager.size(), sizeof(key.queueManager) - 1));
+        key.takenAt = INT64_MIN;
+        auto first = std::lower_bound(entries.begin(), entries.end(), key, SnapshotFormat::entryLess);
+        key.takenAt = INT64_MAX;
+        auto last = std::upper_bound(entries.begin(), entries.end(), key, SnapshotFormat::entryLess);
+        const SnapshotIndexEntry* begin = entries.data();
+        return {begin + (first - entries.begin()), begin + (last - entries.begin())};
+    }
+
+    // The block of entry; not valid() if the entry or the block is damaged
+    SnapshotBlockView block(const SnapshotIndexEntry& entry) const {
+        if (entry.offset >= size || !SnapshotBlockView::check(data + entry.offset, size - entry.offset) ||
+            memcmp(data + entry.offset, SnapshotFormat::BLOCK_MAGIC, 4) != 0) {
+            return SnapshotBlockView();
+        }
+        return SnapshotBlockView(data + entry.offset);
+    }
+};
+
+/**
+ * Snapshot File Writer - Appends snapshots to one or more snapshot files
+ *
+ * Each append() serialises the snapshot into one buffer and writes it with
+ * a single write() under the writer's lock. Files stay open until close()
+ * or until they have had no appends for a while (e.g. after a daemon rolled
+ * over to a new file), and get their index when they are closed. Appending
+ * to an existing file keeps its blocks in the new index.
+ */
+class SnapshotFileWriter {
+private:
+    struct OpenFile {
+        int fd = -1;
+        uint64_t size = 0;
+        std::vector<SnapshotIndexEntry> entries;
+        std::chrono::steady_clock::time_point lastAppend;
+    };
+
+    MQLog& logger;
+    std::mutex mutex;
+    std::map<std::string, OpenFile> files;
+    std::map<std::string, bool> failedPaths;
+    std::string buffer;
+    size_t blocksWritten = 0;
+    size_t bytesWritten = 0;
+
+    static bool writeAll(int fd, const char* bytes, size_t length) {
+        while (length > 0) {
+#ifdef _WIN32
+            int n = _write(fd, bytes, (unsigned int)length);
+#else
+            ssize_t n = ::write(fd, bytes, length);
+#endif
+            if (n <= 0) return false;
+            bytes += n;
+            length -= (size_t)n;
+        }
+        return true;
+    }
+
+    static void closeFd(int fd) {
+#ifdef _WIN32
+        _close(fd);
+#else
+        ::close(fd);
+#endif
+    }
+
+    template <typename T>
+    void put(const T& value) {
+        buffer.append((const char*)&value, sizeof(T));
+    }
+
+    void pad() {
+        buffer.append(SnapshotFormat::align8(buffer.size()) - buffer.size(), '\0');
+    }
+
+    // Serialise snapshot into buffer as one block
+    void encode(const StatusSnapshot& snapshot, uint32_t qmNameId, std::vector<std::string_view>& strings) {
+        struct Column {
+            uint16_t id;
+            uint8_t type;
+            uint8_t width;
+            const void* values;
+            size_t count;
+        };
+        size_t rows = snapshot.size();
+        std::vector<uint32_t> stringOffsets;
+        stringOffsets.reserve(strings.size() + 1);
+        uint32_t total = 0;
+        for (std::string_view s : strings) {
+            stringOffsets.push_back(total);
+            total += (uint32_t)s.size();
+        }
+        stringOffsets.push_back(total);
+
+        const Column columns[] = {
+            {SNAPSHOT_COL_QUEUE_NAME, SNAPSHOT_TYPE_U32, 4, snapshot.queueName.data(), rows},
+            {SNAPSHOT_COL_QUEUE_TYPE, SNAPSHOT_TYPE_U8, 1, snapshot.queueType.data(), rows},
+            {SNAPSHOT_COL_CURRENT_DEPTH, SNAPSHOT_TYPE_I32, 4, snapshot.currentDepth.data(), rows},
+            {SNAPSHOT_COL_OPEN_INPUT, SNAPSHOT_TYPE_I32, 4, snapshot.openInputCount.data(), rows},
+            {SNAPSHOT_COL_OPEN_OUTPUT, SNAPSHOT_TYPE_I32, 4, snapshot.openOutputCount.data(), rows},
+            {SNAPSHOT_COL_HANDLE_FLAGS, SNAPSHOT_TYPE_U8, 1, snapshot.handleFlags.data(), rows},
+            {SNAPSHOT_COL_CONNECTION, SNAPSHOT_TYPE_U32, 4, snapshot.connection.data(), rows},
+            {SNAPSHOT_COL_USER, SNAPSHOT_TYPE_U32, 4, snapshot.user.data(), rows},
+            {SNAPSHOT_COL_APPLICATION_TAG, SNAPSHOT_TYPE_U32, 4, snapshot.applicationTag.data(), rows},
+            {SNAPSHOT_COL_CHANNEL, SNAPSHOT_TYPE_U32, 4, snapshot.channelName.data(), rows},
+            {SNAPSHOT_COL_PROCESS_ID, SNAPSHOT_TYPE_I32, 4, snapshot.processId.data(), rows},
+            {SNAPSHOT_COL_APPL_TYPE, SNAPSHOT_TYPE_I32, 4, snapshot.applType.data(), rows},
+            {SNAPSHOT_COL_STRING_OFFSETS, SNAPSHOT_TYPE_U32, 4, stringOffsets.data(), stringOffsets.size()},
+            {SNAPSHOT_COL_STRING_DATA, SNAPSHOT_TYPE_BYTES, 1, nullptr, total},
+        };
+        const uint32_t columnCount = sizeof(columns) / sizeof(columns[0]);
+
+        buffer.clear();
+        SnapshotBlockHeader header = {};
+        memcpy(header.magic, SnapshotFormat::BLOCK_MAGIC, 4);
+        header.headerBytes = sizeof(SnapshotBlockHeader);
+        header.takenAt = (int64_t)snapshot.timestamp();
+        header.rowCount = (uint32_t)rows;
+        header.stringCount = (uint32_t)strings.size();
+        header.columnCount = columnCount;
+        header.flags = snapshot.isPartial() ? (uint32_t)SNAPSHOT_BLOCK_PARTIAL : 0u;
+        header.queueManager = qmNameId;
+        put(header);
+
+        // Directory first, with offsets filled in as the columns are laid out
+        size_t directoryAt = buffer.size();
+        buffer.append(columnCount * sizeof(SnapshotColumnInfo), '\0');
+        pad();
+        for (uint32_t i = 0; i < columnCount; i++) {
+            SnapshotColumnInfo info = {};
+            info.id = columns[i].id;
+            info.type = columns[i].type;
+            info.width = columns[i].width;
+            info.count = (uint32_t)columns[i].count;
+            info.offset = buffer.size();
+            memcpy(&buffer[directoryAt + i * sizeof(SnapshotColumnInfo)], &info, sizeof(info));
+
+            if (columns[i].id == SNAPSHOT_COL_STRING_DATA) {
+                for (std::string_view s : strings) buffer.append(s.data(), s.size());
+            } else {
+                buffer.append((const char*)columns[i].values, columns[i].count * columns[i].width);
+            }
+            pad();
+        }
+
+        uint64_t blockBytes = buffer.size();
+        memcpy(&buffer[offsetof(SnapshotBlockHeader, blockBytes)], &blockBytes, sizeof(blockBytes));
+    }
+
+    // The open file for path, creating it or picking up the index of an existing one
+    OpenFile* fileFor(const std::string& path) {
+        auto it = files.find(path);
+        if (it != files.end()) return &it->second;
+        if (failedPaths.count(path)) return nullptr;
+
+        OpenFile file;
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec) && std::filesystem::file_size(path, ec) > 0) {
+            SnapshotFileReader existing;
+            if (!existing.open(path)) {
+                logger.error("Not appending to {}: {}", path, existing.error());
+                failedPaths[path] = true;
+                return nullptr;
+            }
+            file.entries = existing.index();
+        }
+
+        std::filesystem::path dir = std::filesystem::path(path).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+#ifdef _WIN32
+        file.fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        file.fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+        if (file.fd < 0) {
+            logger.error("Could not open snapshot file: {}", path);
+            failedPaths[path] = true;
+            return nullptr;
+        }
+
+        struct stat info;
+        fstat(file.fd, &info);
+        file.size = (uint64_t)info.st_size;
+        if (file.size == 0) {
+            SnapshotFileHeader header = {};
+            memcpy(header.magic, SnapshotFormat::FILE_MAGIC, 8);
+            header.version = SnapshotFormat::VERSION;
+            header.headerBytes = sizeof(SnapshotFileHeader);
+            header.createdAt = (int64_t)time(0);
+            if (!writeAll(file.fd, (const char*)&header, sizeof(header))) {
+                logger.error("Could not write the header of snapshot file {}", path);
+                closeFd(file.fd);
+                failedPaths[path] = true;
+                return nullptr;
+            }
+            file.size = sizeof(header);
+        }
+        return &files.emplace(path, std::move(file)).first->second;
+    }
+
+    // Write the index block and trailer, then close; caller holds the mutex
+    void finish(const std::string& path, OpenFile& file) {
+        std::stable_sort(file.entries.begin(), file.entries.end(), SnapshotFormat::entryLess);
+
+        buffer.clear();
+        SnapshotBlockHeader header = {};
+        memcpy(header.magic, SnapshotFormat::INDEX_MAGIC, 4);
+        header.headerBytes = sizeof(SnapshotBlockHeader);
+        header.takenAt = (int64_t)time(0);
+        header.rowCount = (uint32_t)file.entries.size();
+        header.blockBytes = sizeof(SnapshotBlockHeader) + file.entries.size() * sizeof(SnapshotIndexEntry);
+        put(header);
+        for (const auto& entry : file.entries) put(entry);
+
+        SnapshotFileTrailer trailer = {};
+        trailer.indexOffset = file.size;
+        trailer.blockCount = file.entries.size();
+        memcpy(trailer.magic, SnapshotFormat::TRAILER_MAGIC, 8);
+        put(trailer);
+
+        if (!writeAll(file.fd, buffer.data(), buffer.size())) {
+            logger.error("Could not write the index of snapshot file {}", path);
+        }
+        closeFd(file.fd);
+    }
+
+public:
+    explicit SnapshotFileWriter(MQLog& log) : logger(log) {}
+    ~SnapshotFileWriter() { close(); }
+
+    SnapshotFileWriter(const SnapshotFileWriter&) = delete;
+    SnapshotFileWriter& operator=(const SnapshotFileWriter&) = delete;
+
+    // Append one snapshot as a block of the file at path
+    bool append(const std::string& path, const StatusSnapshot& snapshot) {
+        // The block's dictionary is the snapshot's, plus the queue manager name
+        std::vector<std::string_view> strings;
+        strings.reserve(snapshot.dictionarySize() + 1);
+        for (uint32_t id = 0; id < (uint32_t)snapshot.dictionarySize(); id++) strings.push_back(snapshot.text(id));
+        uint32_t qmNameId = (uint32_t)strings.size();
+        strings.push_back(snapshot.queueManager());
+
+        std::lock_guard<std::mutex> guard(mutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = files.begin(); it != files.end();) {
+            if (it->first != path && now - it->second.lastAppend > std::chrono::minutes(5)) {
+                finish(it->first, it->second);
+                it = files.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        OpenFile* file = fileFor(path);
+        if (!file) return false;
+
+        encode(snapshot, qmNameId, strings);
+        if (!writeAll(file->fd, buffer.data(), buffer.size())) {
+            // Part of the block may be on disk: index what is there at the
+            // file's real end, and append nothing more to it this run
+            logger.error("Write to snapshot file {} failed, closing it", path);
+            struct stat info;
+            if (fstat(file->fd, &info) == 0) file->size = (uint64_t)info.st_size;
+            finish(path, *file);
+            files.erase(path);
+            failedPaths[path] = true;
+            return false;
+        }
+
+        SnapshotIndexEntry entry = {};
+        entry.offset = file->size;
+        entry.takenAt = (int64_t)snapshot.timestamp();
+        entry.rowCount = (uint32_t)snapshot.size();
+        entry.flags = snapshot.isPartial() ? (uint32_t)SNAPSHOT_BLOCK_PARTIAL : 0u;
+        memcpy(entry.queueManager, snapshot.queueManager().data(),
+               std::min(snapshot.queueManager().size(), sizeof(entry.queueManager) - 1));
+        file->entries.push_back(entry);
+        file->size += buffer.size();
+        file->lastAppend = now;
+        blocksWritten++;
+        bytesWritten += buffer.size();
+        return true;
+    }
+
+    // Index and close every open file
+    void close() {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto& entry : files) finish(entry.first, entry.second);
+        files.clear();
+        if (blocksWritten > 0) {
+            logger.info("Snapshot writer: {} snapshot(s), {} KiB", blocksWritten, bytesWritten / 1024);
+            blocksWritten = 0;
+            bytesWritten = 0;
+        }
+    }
+};
+
+#endif // MQ_SNAPSHOT_FILE_H
@@ -0,0 +1,218 @@
+#ifndef MQ_STATUS_SNAPSHOT_H
+#define MQ_STATUS_SNAPSHOT_H
+
+#include <cmqc.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include "mq_string_interner.h"
+#include "mq_pcf_status_inquirer.h"
+
+/**
+ * Status Snapshot - Columnar copy of one poll's status rows
+ *
+ * Rows are stored as a struct of arrays: one vector per attribute, integer
+ * columns for counts and the PID, one-byte code columns for the queue type
+ * (MQQT_*) and the handle's role, and dictionary columns (IDs into a
+ * StringInterner) for names. Filters, sorts and aggregates are plain scans
+ * over the few columns they need, and no text exists until a row is handed
+ * to an output sink through forEachRow().
+ */
+
+// Bits of the handleFlags column
+enum SnapshotHandleFlags : uint8_t {
+    SNAPSHOT_HAS_HANDLE = 1,   // The row describes an open handle
+    SNAPSHOT_READER     = 2,   // Opened for input
+    SNAPSHOT_WRITER     = 4    // Opened for output
+};
+
+// Aggregates of one snapshot, computed by column scans
+struct SnapshotSummary {
+    size_t rows = 0;
+    size_t queues = 0;
+    size_t queuesWithMessages = 0;
+    long long totalDepth = 0;
+    MQLONG maxDepth = 0;
+    std::string_view deepestQueue;
+    size_t handles = 0;
+    size_t readers = 0;
+    size_t writers = 0;
+};
+
+class StatusSnapshot {
+private:
+    std::string qmName;
+    time_t takenAt = 0;
+    bool partial = false;
+    StringInterner dictionary;
+
+public:
+    // Queue-level columns
+    std::vector<uint32_t> queueName;       // Dictionary ID
+    std::vector<uint8_t> queueType;        // MQQT_*
+    std::vector<int32_t> currentDepth;
+    std::vector<int32_t> openInputCount;
+    std::vector<int32_t> openOutputCount;
+
+    // Handle-level columns (meaningful when SNAPSHOT_HAS_HANDLE is set)
+    std::vector<uint8_t> handleFlags;      // SnapshotHandleFlags
+    std::vector<uint32_t> connection;      // Dictionary IDs
+    std::vector<uint32_t> user;
+    std::vector<uint32_t> applicationTag;
+    std::vector<uint32_t> channelName;
+    std::vector<int32_t> processId;
+    std::vector<int32_t> applType;         // MQAT_*, or PCFHandleRecord::NO_APPL_TYPE
+
+    explicit StatusSnapshot(const std::string& qm = "") : qmName(qm), takenAt(time(0)) {}
+
+    StatusSnapshot(const StatusSnapshot&) = delete;
+    StatusSnapshot& operator=(const StatusSnapshot&) = delete;
+
+    const std::string& queueManager() const { return qmName; }
+    time_t timestamp() const { return takenAt; }
+
+    // Set when the poll behind the snapshot missed replies (deadline or errors)
+    bool isPartial() const { return partial; }
+    void markPartial(bool value = true) { partial = value; }
+    size_t size() const { return queueName.size(); }
+    std::string_view text(uint32_t id) const { return dictionary.view(id); }
+    size_t dictionarySize() const { return dictionary.size(); }
+
+    // Start a new snapshot; column and dictionary storage is kept
+    void reset(const std::string& qm) {
+        qmName = qm;
+        takenAt = time(0);
+        partial = false;
+        dictionary.clear();
+        queueName.clear();
+        queueType.clear();
+        currentDepth.clear();
+        openInputCount.clear();
+        openOutputCount.clear();
+        handleFlags.clear();
+        connection.clear();
+        user.clear();
+        applicationTag.clear();
+        channelName.clear();
+        processId.clear();
+        applType.clear();
+    }
+
+    static uint8_t flagsFor(const PCFHandleRecord* handle) {
+        if (!handle) return 0;
+        MQLONG options = handle->openOptions;
+        uint8_t flags = SNAPSHOT_HAS_HANDLE;
+        if (options & (MQOO_INPUT_AS_Q_DEF | MQOO_INPUT_SHARED | MQOO_INPUT_EXCLUSIVE)) flags |= SNAPSHOT_READER;
+        if (options & MQOO_OUTPUT) flags |= SNAPSHOT_WRITER;
+        return flags;
+    }
+
+    // Copy one row; strings are re-interned into the snapshot's own dictionary
+    void append(const PCFStatusRow& row) {
+        const PCFHandleRecord* h = row.handle;
+        queueName.push_back(dictionary.intern(row.queue.queueName));
+        queueType.push_back((uint8_t)row.queue.queueType);
+        currentDepth.push_back(row.queue.currentDepth);
+        openInputCount.push_back(row.queue.openInputCount);
+        openOutputCount.push_back(row.queue.openOutputCount);
+
+        handleFlags.push_back(flagsFor(h));
+        connection.push_back(h ? dictionary.intern(row.strings.view(h->connection)) : StringInterner::EMPTY);
+        user.push_back(h ? dictionary.intern(row.strings.view(h->user)) : StringInterner::EMPTY);
+        applicationTag.push_back(h ? dictionary.intern(row.strings.view(h->applicationTag)) : StringInterner::EMPTY);
+        channelName.push_back(h ? dictionary.intern(row.strings.view(h->channelName)) : StringInterner::EMPTY);
+        processId.push_back(h ? h->processId : 0);
+        applType.push_back(h ? h->applType : PCFHandleRecord::NO_APPL_TYPE);
+    }
+
+    /**
+     * Hand every row (or the rows listed in order) to fn(const PCFStatusRow&),
+     * so the output sinks turn codes into text only at this point. Open
+     * options are rebuilt from the role bits, which is all the sinks use.
+     */
+    template <typename RowCallback>
+    void forEachRow(RowCallback&& fn, const std::vector<uint32_t>* order = nullptr) const {
+        size_t count = order ? order->size() : size();
+        for (size_t n = 0; n < count; n++) {
+            size_t i = order ? (*order)[n] : n;
+            PCFQueueView queue;
+            queue.queueName = dictionary.view(queueName[i]);
+            queue.queueType = queueType[i];
+            queue.currentDepth = currentDepth[i];
+            queue.openInputCount = openInputCount[i];
+            queue.openOutputCount = openOutputCount[i];
+
+            if (!(handleFlags[i] & SNAPSHOT_HAS_HANDLE)) {
+                fn(PCFStatusRow{queue, nullptr, dictionary});
+                continue;
+            }
+            PCFHandleRecord handle;
+            handle.connection = connection[i];
+            handle.user = user[i];
+            handle.applicationTag = applicationTag[i];
+            handle.channelName = channelName[i];
+            handle.applType = applType[i];
+            handle.processId = processId[i];
+            handle.openOptions = ((handleFlags[i] & SNAPSHOT_READER) ? MQOO_INPUT_AS_Q_DEF : 0) |
+                                 ((handleFlags[i] & SNAPSHOT_WRITER) ? MQOO_OUTPUT : 0);
+            fn(PCFStatusRow{queue, &handle, dictionary});
+        }
+    }
+
+    // Indexes of the rows for which pred(snapshot, row) is true
+    template <typename Predicate>
+    std::vector<uint32_t> select(Predicate&& pred) const {
+        std::vector<uint32_t> rows;
+        for (uint32_t i = 0; i < (uint32_t)size(); i++) {
+            if (pred(*this, i)) rows.push_back(i);
+        }
+        return rows;
+    }
+
+    // Row indexes ordered by descending queue depth (stable within a queue)
+    std::vector<uint32_t> orderByDepth() const {
+        std::vector<uint32_t> rows(size());
+        for (uint32_t i = 0; i < (uint32_t)rows.size(); i++) rows[i] = i;
+        std::stable_sort(rows.begin(), rows.end(), [this](uint32_t a, uint32_t b) {
+            return currentDepth[a] > currentDepth[b];
+        });
+        return rows;
+    }
+
+    SnapshotSummary summarize() const {
+        SnapshotSummary summary;
+        summary.rows = size();
+
+        // A queue appears once per handle; count each dictionary ID once
+        std::vector<bool> seen(dictionary.size(), false);
+        for (size_t i = 0; i < size(); i++) {
+            if (seen[queueName[i]]) continue;
+            seen[queueName[i]] = true;
+            summary.queues++;
+            if (currentDepth[i] > 0) summary.queuesWithMessages++;
+            summary.totalDepth += currentDepth[i];
+            if (currentDepth[i] > summary.maxDepth) {
+                summary.maxDepth = currentDepth[i];
+                summary.deepestQueue = dictionary.view(queueName[i]);
+            }
+        }
+
+        for (uint8_t flags : handleFlags) {
+            if (flags & SNAPSHOT_HAS_HANDLE) summary.handles++;
+            if (flags & SNAPSHOT_READER) summary.readers++;
+            if (flags & SNAPSHOT_WRITER) summary.writers++;
+        }
+        return summary;
+    }
+
+    // Bytes held by the columns and the dictionary
+    size_t memoryBytes() const {
+        size_t perRow = 5 * sizeof(uint32_t) + 5 * sizeof(int32_t) + 2 * sizeof(uint8_t);
+        return size() * perRow + dictionary.bytesUsed() + dictionary.size() * sizeof(std::string_view);
+    }
+};
+
+#endif // MQ_STATUS_SNAPSHOT_H
@@ -0,0 +1,109 @@
+#ifndef MQ_STRING_INTERNER_H
+#define MQ_STRING_INTERNER_H
+
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+/**
+ * String Interner - Arena-backed store of distinct strings
+ *
+ * Each distinct value is copied once into a chunk of the arena and given a
+ * small integer ID; interning the same value again only costs a hash lookup.
+ * Chunks never move, so the string_views handed out stay valid until
+ * clear(). clear() forgets every string but keeps the chunks, so a snapshot
+ * of the same shape is interned again without allocating.
+ *
+ * ID 0 is always the empty string.
+ */
+class StringInterner {
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity;
+    };
+
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<Chunk> chunks;
+    size_t currentChunk = 0;
+    size_t chunkUsed = 0;
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> index;
+    size_t lookups = 0;
+
+    const char* store(std::string_view value) {
+        if (chunks.empty()) {
+            chunks.push_back(Chunk{std::unique_ptr<char[]>(new char[CHUNK_SIZE]), CHUNK_SIZE});
+        }
+        while (chunks[currentChunk].capacity - chunkUsed < value.size()) {
+            currentChunk++;
+            chunkUsed = 0;
+            if (currentChunk == chunks.size()) {
+                size_t capacity = std::max(CHUNK_SIZE, value.size());
+                chunks.push_back(Chunk{std::unique_ptr<char[]>(new char[capacity]), capacity});
+            }
+        }
+        char* dst = chunks[currentChunk].data.get() + chunkUsed;
+        memcpy(dst, value.data(), value.size());
+        chunkUsed += value.size();
+        return dst;
+    }
+
+public:
+    static constexpr uint32_t EMPTY = 0;
+
+    StringInterner() { clear(); }
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // ID of value, copying it into the arena the first time it is seen
+    uint32_t intern(std::string_view value) {
+        lookups++;
+        auto it = index.find(value);
+        if (it != index.end()) return it->second;
+
+        std::string_view stored(value.empty() ? "" : store(value), value.size());
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(stored);
+        index.emplace(stored, id);
+        return id;
+    }
+
+    // ID of value if it has been interned, without adding it
+    bool find(std::string_view value, uint32_t& id) const {
+        auto it = index.find(value);
+        if (it == index.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    std::string_view view(uint32_t id) const { return strings[id]; }
+
+    // Forget every string; arena chunks are kept for reuse
+    void clear() {
+        strings.clear();
+        index.clear();
+        currentChunk = 0;
+        chunkUsed = 0;
+        lookups = 0;
+        strings.push_back(std::string_view());
+        index.emplace(std::string_view(), EMPTY);
+    }
+
+    size_t size() const { return strings.size(); }
+    size_t lookupCount() const { return lookups; }
+
+    size_t bytesUsed() const {
+        size_t total = 0;
+        for (const auto& s : strings) total += s.size();
+        return total;
+    }
+};
+
+#endif // MQ_STRING_INTERNER_H
@@ -2,57 +2,244 @@
 #define MQ_THREAD_POOL_H
 
 #include <thread>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
+#include <memory>
+#include <future>
 #include <functional>
 #include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
 
+// Lanes of the pool; workers take every High task before any Normal one
+enum class TaskPriority {
+    High = 0,       // Interactive or on-demand inquiries
+    Normal = 1      // Bulk polls
+};
+
+/**
+ * A set of tasks that can be awaited or cancelled apart from the rest of the
+ * pool. Cancelling skips the group's tasks that have not started (their
+ * futures report std::future_errc::broken_promise); running tasks can check
+ * cancelled() and stop early. The destructor waits for the group's tasks.
+ */
+class TaskGroup {
+private:
+    friend class ThreadPool;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t outstanding = 0;
+    size_t skippedCount = 0;
+    std::atomic<bool> cancelFlag{false};
+
+    void added() {
+        std::lock_guard<std::mutex> guard(mutex);
+        outstanding++;
+    }
+
+    // True when this was the group's last task
+    bool done(bool skipped) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (skipped) skippedCount++;
+        if (--outstanding > 0) return false;
+        finished.notify_all();
+        return true;
+    }
+
+public:
+    TaskGroup() = default;
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void cancel() { cancelFlag = true; }
+    bool cancelled() const { return cancelFlag; }
+
+    // Block until every task of the group ran or was skipped
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return outstanding == 0; });
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return outstanding;
+    }
+
+    // Tasks dropped because the group was cancelled before they started
+    size_t skipped() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return skippedCount;
+    }
+};
+
+/**
+ * Thread Pool - Work-stealing workers with priority lanes
+ *
+ * Every worker owns a deque per lane. Tasks submitted from outside the pool
+ * are dealt round-robin over the workers; tasks submitted by a worker go to
+ * its own deque, next to the work that spawned them. A worker takes the
+ * newest task of its own deque, usually a subtask of what it just ran and
+ * whose data is still in its cache. When its deque is empty it steals the
+ * oldest task of another worker's, which is the least likely to be one the
+ * owner is about to need. The two ends rarely contend, and no worker idles
+ * while any deque holds work. Each deque has its own small lock instead of
+ * all workers sharing one queue lock.
+ *
+ * enqueue() returns a std::future for the task's result (or exception).
+ */
 class ThreadPool {
 private:
+    static constexpr size_t LANES = 2;
+
+    struct Task {
+        std::function<void()> run;
+        TaskGroup* group = nullptr;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> lanes[LANES];
+        std::atomic<size_t> sizes[LANES] = {};    // Lets other workers skip empty deques without locking
+    };
+
+    std::vector<std::unique_ptr<Worker>> queues;
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queueMutex;
+    std::mutex stateMutex;
     std::condition_variable condition;
     std::condition_variable doneCondition;
-    bool stop = false;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> queuedTasks{0};
     std::atomic<int> activeTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> stealCount{0};
+    std::atomic<int> sleepingWorkers{0};    // Workers waiting on condition
+    std::atomic<int> waitingCallers{0};     // Threads waiting in waitAll()
+
+    // The pool and worker index of the calling thread
+    static const ThreadPool*& workerOwner() {
+        static thread_local const ThreadPool* owner = nullptr;
+        return owner;
+    }
+
+    static size_t& workerIndex() {
+        static thread_local size_t index = SIZE_MAX;
+        return index;
+    }
+
+    // Index of the calling worker in this pool, or SIZE_MAX outside of it
+    size_t currentWorker() const {
+        return workerOwner() == this ? workerIndex() : SIZE_MAX;
+    }
+
+    void push(Task task, TaskPriority priority) {
+        size_t self = currentWorker();
+        size_t target = self != SIZE_MAX ? self : nextQueue++ % queues.size();
+        {
+            // Counted before the task can be taken, so take() never brings queuedTasks below zero
+            std::lock_guard<std::mutex> guard(queues[target]->mutex);
+            queuedTasks++;
+            queues[target]->lanes[(size_t)priority].push_back(std::move(task));
+            queues[target]->sizes[(size_t)priority]++;
+        }
+        // A worker counts itself as sleeping before it checks queuedTasks, so
+        // either it sees this task or the lock is needed here to wake it
+        if (sleepingWorkers.load() > 0) {
+            std::lock_guard<std::mutex> guard(stateMutex);
+            condition.notify_one();
+        }
+    }
+
+    // Own deque first (newest task), then the other workers' (oldest task), lane by lane
+    bool take(size_t self, Task& task) {
+        size_t count = queues.size();
+        for (size_t lane = 0; lane < LANES; lane++) {
+            for (size_t n = 0; n < count; n++) {
+                size_t victim = (self + n) % count;
+                Worker& worker = *queues[victim];
+                if (worker.sizes[lane].load() == 0) continue;
+                std::lock_guard<std::mutex> guard(worker.mutex);
+                auto& deque = worker.lanes[lane];
+                if (deque.empty()) continue;
+                worker.sizes[lane]--;
+                if (n == 0) {
+                    task = std::move(deque.back());
+                    deque.pop_back();
+                } else {
+                    task = std::move(deque.front());
+                    deque.pop_front();
+                    stealCount++;
+                }
+                activeTasks++;
+                queuedTasks--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(Task& task) {
+        bool skipped = task.group && task.group->cancelled();
+        if (!skipped) task.run();
+        task.run = nullptr;     // Drops a skipped task's promise before the group is released
+        if (task.group && task.group->done(skipped) && sleepingWorkers.load() > 0) {
+            // A worker in wait() may be sleeping on this group
+            std::lock_guard<std::mutex> guard(stateMutex);
+            condition.notify_all();
+        }
+        if (--activeTasks == 0 && queuedTasks.load() == 0 && waitingCallers.load() > 0) {
+            std::lock_guard<std::mutex> guard(stateMutex);
+            doneCondition.notify_all();
+        }
+    }
+
+    void workerLoop(size_t self) {
+        workerOwner() = this;
+        workerIndex() = self;
+        while (true) {
+            Task task;
+            if (take(self, task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(stateMutex);
+            sleepingWorkers++;
+            condition.wait(lock, [this] { return stop || queuedTasks.load() > 0; });
+            sleepingWorkers--;
+            if (stop && queuedTasks.load() == 0) return;
+        }
+    }
+
+    template<class F>
+    auto submit(F&& f, TaskGroup* group, TaskPriority priority)
+        -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(f));
+        std::future<Result> result = packaged->get_future();
+        if (stop)
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        if (group) group->added();
+        push(Task{[packaged] { (*packaged)(); }, group}, priority);
+        return result;
+    }
 
 public:
     ThreadPool(size_t numThreads) {
+        if (numThreads == 0) numThreads = 1;
+        for (size_t i = 0; i < numThreads; ++i) queues.emplace_back(new Worker());
         for (size_t i = 0; i < numThreads; ++i) {
-            workers.emplace_back([this] {
-                while (true) {
-                    std::function<void()> task;
-
-                    {
-                        std::unique_lock<std::mutex> lock(queueMutex);
-                        condition.wait(lock, [this] { return stop || !tasks.empty(); });
-
-                        if (stop && tasks.empty())
-                            return;
-
-                        if (!tasks.empty()) {
-                            task = std::move(tasks.front());
-                            tasks.pop();
-                            activeTasks++;
-                        }
-                    }
-
-                    if (task) {
-                        task();
-                        activeTasks--;
-                        doneCondition.notify_all();
-                    }
-                }
-            });
+            workers.emplace_back([this, i] { workerLoop(i); });
         }
     }
 
     ~ThreadPool() {
         {
-            std::unique_lock<std::mutex> lock(queueMutex);
+            std::unique_lock<std::mutex> lock(stateMutex);
             stop = true;
         }
         condition.notify_all();
@@ -61,26 +248,74 @@ public:
     }
 
     template<class F>
-    void enqueue(F&& f) {
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (stop)
-                throw std::runtime_error("enqueue on stopped ThreadPool");
-            tasks.emplace(std::forward<F>(f));
+    auto enqueue(F&& f, TaskPriority priority = TaskPriority::Normal) {
+        return submit(std::forward<F>(f), nullptr, priority);
+    }
+
+    template<class F>
+    auto enqueue(TaskGroup& group, F&& f, TaskPriority priority = TaskPriority::Normal) {
+        return submit(std::forward<F>(f), &group, priority);
+    }
+
+    // Fire-and-forget: no future to allocate; an exception thrown by f is lost
+    template<class F>
+    void post(F&& f, TaskPriority priority = TaskPriority::Normal) {
+        post(nullptr, std::forward<F>(f), priority);
+    }
+
+    template<class F>
+    void post(TaskGroup* group, F&& f, TaskPriority priority = TaskPriority::Normal) {
+        if (stop)
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        if (group) group->added();
+        push(Task{[task = std::forward<F>(f)]() mutable {
+            try {
+                task();
+            } catch (...) {
+            }
+        }, group}, priority);
+    }
+
+    /**
+     * Wait for a group. Called from one of the pool's workers, the caller
+     * runs queued tasks meanwhile instead of blocking a worker, and sleeps
+     * like an idle worker while the group's last tasks run elsewhere.
+     */
+    void wait(TaskGroup& group) {
+        size_t self = currentWorker();
+        if (self == SIZE_MAX) {
+            group.wait();
+            return;
+        }
+        while (group.pending() > 0) {
+            Task task;
+            if (take(self, task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(stateMutex);
+            sleepingWorkers++;
+            condition.wait(lock, [this, &group] { return queuedTasks.load() > 0 || group.pending() == 0; });
+            sleepingWorkers--;
         }
-        condition.notify_one();
     }
 
     size_t pendingTasks() {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        return tasks.size();
+        return queuedTasks.load();
+    }
+
+    // Tasks taken from another worker's deque since the pool started
+    size_t steals() const {
+        return stealCount.load();
     }
 
     void waitAll() {
-        std::unique_lock<std::mutex> lock(queueMutex);
+        std::unique_lock<std::mutex> lock(stateMutex);
+        waitingCallers++;
         doneCondition.wait(lock, [this] {
-            return tasks.empty() && activeTasks.load() == 0;
+            return queuedTasks.load() == 0 && activeTasks.load() == 0;
         });
+        waitingCallers--;
     }
 };
 